@@ -1,15 +1,10 @@
 #include "BluetoothConnection.h"
 #include "BluetoothServer.h"
 #include "Utility.h"
+#include "Trace.h"
+#include "Metrics.h"
 #include <esp_log.h>
 
-#ifdef USER_MANAGEMENT_ENABLED
-
-#include "ConnectedUser.h"
-#include "UserManager.h"
-
-#endif
-
 #include "JsonModels.h"
 #include "BluetoothErrorCodes.h"
 #include "GeneralErrorCodes.h"
@@ -21,11 +16,7 @@
 
 BluetoothConnection::BluetoothConnection()
         : BaseConnection(), _writeCharacteristic(nullptr), _notifyCharacteristic(nullptr), _sendMutex(nullptr),
-          _isConnected(false), _connId(0)
-#ifdef USER_MANAGEMENT_ENABLED
-        , _user(nullptr)
-#endif
-{}
+          _isConnected(false), _connId(0) {}
 
 BluetoothConnection::~BluetoothConnection() {
     disconnect(); // NOLINT
@@ -34,15 +25,20 @@ BluetoothConnection::~BluetoothConnection() {
     }
 }
 
-ErrorCode BluetoothConnection::initialize() {
-    _writeCharacteristic = BluetoothServer::instance().createPrivateWriteCharacteristic();
+ErrorCode BluetoothConnection::initialize(NimBLEService* service) {
+    if (service == nullptr) {
+        ESP_LOGE(__FUNCTION__, "Private service not created.");
+        return CommonErrorCodes::BluetoothServiceCreationFailed;
+    }
+
+    _writeCharacteristic = BluetoothServer::instance().createWriteCharacteristic(service);
     if (!_writeCharacteristic) {
         ESP_LOGE(__FUNCTION__, "Failed to create write characteristic.");
         return CommonErrorCodes::BluetoothCharacteristicCreationFailed;
     }
     _writeCharacteristic->setCallbacks(this);
 
-    _notifyCharacteristic = BluetoothServer::instance().createPrivateNotifyCharacteristic();
+    _notifyCharacteristic = BluetoothServer::instance().createNotifyCharacteristic(service);
     if (!_notifyCharacteristic) {
         ESP_LOGE(__FUNCTION__, "Failed to create notify characteristic.");
         return CommonErrorCodes::BluetoothCharacteristicCreationFailed;
@@ -74,13 +70,6 @@ void BluetoothConnection::disconnect() {
     _isConnected = false;
     _connId = 0;
 
-#ifdef USER_MANAGEMENT_ENABLED
-    if (_user != nullptr) {
-        UserManager::disconnect(_user);
-        _user = nullptr;
-    }
-#endif
-
     onDisconnect.trigger(this, nullptr);
 }
 
@@ -97,11 +86,16 @@ bool BluetoothConnection::isConnected() const {
 }
 
 void BluetoothConnection::onWrite(NimBLECharacteristic *pCharacteristic, NimBLEConnInfo &connInfo) {
+    TraceSpan span("BluetoothConnection::onWrite", "ble");
     std::string rxValue = pCharacteristic->getValue();
 
     if (rxValue.length() > 0) {
         ESP_LOGI(__FUNCTION__, "Received data from connection ID %d: %s", _connId, rxValue.c_str());
-        Commander::executeCommand(rxValue, this);
+        // Não bloqueia o host BLE: o comando vai para a fila do Commander (Busy já é respondido por ele)
+        ErrorCode err = Commander::CheckForCommand(rxValue, this);
+        if (err != CommonErrorCodes::None && err != CommonErrorCodes::Busy) {
+            err.log(__FUNCTION__, ESP_LOG_WARN);
+        }
     }
 }
 
@@ -117,7 +111,7 @@ ErrorCode BluetoothConnection::sendRawData(const uint8_t *data, size_t length) c
     return sendRawData(data, length, true); // Default to notification
 }
 
-ErrorCode BluetoothConnection::sendData(const std::vector<uint8_t> &data, bool isNotification) {
+ErrorCode BluetoothConnection::sendData(const ByteBuffer &data, bool isNotification) {
     if (!_isConnected) {
         return CommonErrorCodes::ConnectionClosed;
     }
@@ -132,29 +126,11 @@ std::string BluetoothConnection::getNotifyUUID() const {
     return _notifyCharacteristic->getUUID().toString();
 }
 
-#ifdef USER_MANAGEMENT_ENABLED
-
-void BluetoothConnection::setUser(ConnectedUser *user) {
-    _user = user;
-}
-
-ConnectedUser *BluetoothConnection::getUser(bool canBeNull, bool canBeEmpty) {
-    if (_user == nullptr && !canBeNull) {
-        ESP_LOGE(__FUNCTION__, "Returning a null user (not allowed)!");
-    } else if (_user != nullptr && _user->User.empty() && !canBeEmpty) {
-        ESP_LOGE(__FUNCTION__, "Returning a user with an empty name (not allowed)!");
-    }
-    return _user;
-}
-
-void BluetoothConnection::logoff() {
-    _user = nullptr;
-}
-
-#endif
-
 // Private method
 ErrorCode BluetoothConnection::sendRawData(const uint8_t *data, size_t length, bool isNotification) const {
+    TraceSpan span("BluetoothConnection::sendRawData", "ble");
+    static Histogram &notifyLatency = Metrics::histogram("ble.notify_us");
+    int64_t start = Metrics::now();
     if (xSemaphoreTake(_sendMutex, 1000 / portTICK_PERIOD_MS) != pdTRUE) {
         ESP_LOGE(__FUNCTION__, "Failed to acquire mutex.");
         return CommonErrorCodes::Timeout;
@@ -164,6 +140,8 @@ ErrorCode BluetoothConnection::sendRawData(const uint8_t *data, size_t length, b
 
     if (isNotification) {
         _notifyCharacteristic->notify();
+        // Inclui a espera pelo mutex, que é o que o chamador sente
+        notifyLatency.record(static_cast<uint32_t>(Metrics::now() - start));
     } else {
         _notifyCharacteristic->indicate();
     }
@@ -8,10 +8,6 @@
 #include "JsonModels.h"
 #include "projectConfig.h"
 
-#ifdef USER_MANAGEMENT_ENABLED
-#include "ConnectedUser.h"
-#endif
-
 /**
  * @file BluetoothConnection.h
  * @brief This file defines the BluetoothConnection class for managing individual Bluetooth connections.
@@ -19,7 +15,7 @@
 
 /**
  * @class BluetoothConnection
- * @brief Represents a single Bluetooth connection, handling data transmission, notifications, and user management (optional).
+ * @brief Represents a single Bluetooth connection, handling data transmission and notifications.
  *
  * This class inherits from BaseConnection to provide a consistent interface for communication connections.
  */
@@ -38,9 +34,10 @@ public:
     /**
      * @brief Initializes the BluetoothConnection, creating the necessary characteristics and mutex.
      *
+     * @param service The private service that gets the write and notify characteristics of this connection.
      * @return ErrorCode indicating success or failure of the initialization process.
      */
-    ErrorCode initialize();
+    ErrorCode initialize(NimBLEService* service);
 
     /**
      * @brief Connects the BluetoothConnection to a specific connection ID.
@@ -91,7 +88,9 @@ public:
      * @param isNotification If true, send as a notification; otherwise, send as an indication.
      * @return ErrorCode indicating success or failure of the send operation.
      */
-    ErrorCode sendData(const std::vector<uint8_t>& data, bool isNotification);
+    ErrorCode sendData(const ByteBuffer& data, bool isNotification);
+
+    using BaseConnection::sendData;
 
     /**
      * @brief Gets the UUID of the write characteristic.
@@ -114,29 +113,6 @@ public:
      */
     [[nodiscard]] std::string getConnectionInfoJson() const;
 
-#ifdef USER_MANAGEMENT_ENABLED
-    /**
-     * @brief Sets the ConnectedUser associated with this connection.
-     *
-     * @param user A pointer to the ConnectedUser object.
-     */
-    void setUser(ConnectedUser* user);
-
-    /**
-     * @brief Gets the ConnectedUser associated with this connection.
-     *
-     * @param canBeNull If true, the function can return nullptr if no user is assigned.
-     * @param canBeEmpty If true, the function can return a ConnectedUser with an empty user name.
-     * @return A pointer to the ConnectedUser, or nullptr if no user is assigned (and `canBeNull` is true).
-     */
-    ConnectedUser* getUser(bool canBeNull = true, bool canBeEmpty = true);
-
-    /**
-     * @brief Logs off the user, clearing the user data and updating notification needs.
-     */
-    void logoff();
-#endif
-
 private:
     NimBLECharacteristic* _writeCharacteristic; /**< Characteristic for receiving write commands. */
     NimBLECharacteristic* _notifyCharacteristic; /**< Characteristic for sending notifications. */
@@ -145,10 +121,6 @@ private:
     bool _isConnected; /**< Flag indicating if the connection is active. */
     uint16_t _connId; /**< The connection ID. */
 
-#ifdef USER_MANAGEMENT_ENABLED
-    ConnectedUser* _user; /**< Pointer to the associated ConnectedUser object (if user management is enabled). */
-#endif
-
     /**
      * @brief Sends a raw byte array over the notification characteristic.
      *
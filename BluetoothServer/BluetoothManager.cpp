@@ -1,6 +1,7 @@
 #include "BluetoothManager.h"
 #include "JsonModels.h"
 #include "ConnectionManager.h"
+#include "BluetoothServer.h"
 #include "BluetoothErrorCodes.h"
 #include "GeneralErrorCodes.h"
 #include <esp_random.h>
@@ -66,6 +67,13 @@ ErrorCode BluetoothManager::initialize() {
         return CommonErrorCodes::BluetoothCharacteristicCreationFailed;
     }
 
+    // Preallocate the connections before onConnect can take one from the pool
+    ErrorCode err = createConnections(_privateService);
+    if (err != CommonErrorCodes::None) {
+        ESP_LOGE("BluetoothManager", "Failed to create the connection pool: %s", err.description().c_str());
+        return err;
+    }
+
     // Set callbacks for server and characteristic events
     BleServer->setCallbacks(new ServerCallbacks());
     _publicTxCharacteristic->setCallbacks(new SendDataCallbacks());
@@ -92,32 +100,39 @@ std::string BluetoothManager::getPrivateServiceUUID() const {
     return _privateServiceUUID;
 }
 
+ErrorCode BluetoothManager::createConnections(NimBLEService* service) {
+    _poolService = service;
+    return ConnectionManager::initialize(BLUETOOTH_MAX_CONNECTIONS, []() -> BaseConnection * {
+        return BluetoothManager::instance().createConnection();
+    });
+}
+
 BluetoothConnection* BluetoothManager::createConnection() {
     auto* connection = new BluetoothConnection();
-    ErrorCode err = connection->initialize();
+    ErrorCode err = connection->initialize(_poolService);
     if (err != CommonErrorCodes::None) {
         ESP_LOGE("BluetoothManager", "Failed to initialize BluetoothConnection: %s", err.description().c_str());
         delete connection;
         return nullptr;
     }
 
-    ConnectionManager::addConnection(connection); // Assuming ConnectionManager handles the list
     return connection;
 }
 
 void BluetoothManager::ServerCallbacks::onConnect(NimBLEServer* pServer, NimBLEConnInfo& connInfo) {
-    (void)pServer; // Parameter not used currently 
-
     NimBLEDevice::startAdvertising();
     ESP_LOGI("BluetoothManager", "Client connected: %s", connInfo.getAddress().toString().c_str());
 
-    auto* connection = BluetoothManager::instance().createConnection();
-    if (connection) {
-        connection->connect(connInfo.getAddress().getNative()[5]); // Connect using last byte of address
+    // Take a preallocated connection from the pool; nothing is allocated here
+    uint16_t id = connInfo.getConnHandle();
+    ErrorCode err = ConnectionManager::connect(id);
+    auto* connection = dynamic_cast<BluetoothConnection*>(ConnectionManager::getConnectionById(id));
+    if (err == CommonErrorCodes::None && connection) {
+        connection->connect(id); // Connect using the connection handle
         BluetoothManager::onConnection.trigger(&BluetoothManager::instance(), connection);
     } else {
-        ESP_LOGE("BluetoothManager", "Failed to create a new BluetoothConnection.");
-        // Handle error (maybe disconnect the client)
+        ESP_LOGE("BluetoothManager", "Failed to connect handle %d: %s", id, err.description().c_str());
+        pServer->disconnect(id);
     }
 }
 
@@ -128,7 +143,7 @@ void BluetoothManager::ServerCallbacks::onDisconnect(NimBLEServer* pServer, NimB
              connInfo.getAddress().toString().c_str(), reason, NimBLEUtils::returnCodeToString(reason));
 
     // Assuming ConnectionManager handles disconnection
-    ConnectionManager::disconnect(connInfo.getAddress().getNative()[5]);
+    ConnectionManager::disconnect(connInfo.getConnHandle());
 }
 
 void BluetoothManager::SendDataCallbacks::onRead(NimBLECharacteristic* pCharacteristic, NimBLEConnInfo& connInfo) {
@@ -136,7 +151,8 @@ void BluetoothManager::SendDataCallbacks::onRead(NimBLECharacteristic* pCharacte
 
     ESP_LOGI("BluetoothManager", "Client read request from: %s", connInfo.getAddress().toString().c_str());
 
-    auto* connection = ConnectionManager::getConnectionById(connInfo.getAddress().getNative()[5]);
+    uint16_t id = connInfo.getConnHandle();
+    auto* connection = dynamic_cast<BluetoothConnection*>(ConnectionManager::getConnectionById(id));
     if (connection) {
         std::string json = connection->getConnectionInfoJson();
         ErrorCode err = connection->sendJson(json);
@@ -145,7 +161,7 @@ void BluetoothManager::SendDataCallbacks::onRead(NimBLECharacteristic* pCharacte
             // Handle error appropriately 
         }
     } else {
-        ESP_LOGE("BluetoothManager", "Connection not found for ID: %d", connInfo.getAddress().getNative()[5]);
+        ESP_LOGE("BluetoothManager", "Connection not found for ID: %d", id);
         // Handle error (maybe disconnect the client)
     }
 }
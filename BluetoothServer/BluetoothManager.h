@@ -46,6 +46,7 @@ private:
     std::string _privateServiceUUID; /**< The UUID of the private service. */
 
     bool _initialized; /**< Flag to track if the BluetoothManager has been initialized. */
+    NimBLEService* _poolService = nullptr; /**< Service of the pool connections, set by createConnections(). */
 
 public:
     /**
@@ -75,9 +76,23 @@ public:
     [[nodiscard]] std::string getPrivateServiceUUID() const;
 
     /**
-     * @brief Creates a new BluetoothConnection object and adds it to the ConnectionManager.
+     * @brief Builds the connection pool: BLUETOOTH_MAX_CONNECTIONS connections with their characteristics.
      *
-     * @return A pointer to the newly created BluetoothConnection.
+     * Both initialize() and BluetoothServer::setup() call it before registering the server callbacks and starting
+     * the services, so a client is never refused because nobody built the pool.
+     *
+     * @param service The private service that gets the characteristics of the connections.
+     * @return ErrorCode from ConnectionManager::initialize.
+     */
+    ErrorCode createConnections(NimBLEService* service);
+
+    /**
+     * @brief Creates and initializes a new BluetoothConnection object (characteristics and mutex).
+     *
+     * Called by ConnectionManager::initialize for each connection of the pool at boot; connecting reuses them.
+     * The characteristics go on the service given to createConnections().
+     *
+     * @return A pointer to the newly created BluetoothConnection, or nullptr on error.
      */
     BluetoothConnection* createConnection();
 
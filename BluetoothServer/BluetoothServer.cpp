@@ -1,6 +1,7 @@
 #include "BluetoothServer.h"
 #include <cstdint>
 #include <esp_log.h>
+#include "BluetoothManager.h"
 #include "ConnectionManager.h"
 #include "Utility.h"
 #include "ConnectedUser.h"
@@ -71,6 +72,12 @@ ErrorCode BluetoothServer::setup(const std::string& deviceName) {
         return CommonErrorCodes::BluetoothServiceCreationFailed;
     }
 
+    // Preallocate the connections and their characteristics before the services start
+    ErrorCode err = BluetoothManager::instance().createConnections(_privateService);
+    if (err != CommonErrorCodes::None) {
+        return err;
+    }
+
     // Set server callbacks
     BleServer->setCallbacks(new ServerCallbacks());
 
@@ -157,23 +164,29 @@ void BluetoothServer::sendJson(NimBLECharacteristic* pCharacteristic, const std:
 
 void BluetoothServer::ServerCallbacks::onConnect(NimBLEServer* pServer, NimBLEConnInfo& connInfo) {
     // Delegate connection handling to the ConnectionManager
-    BluetoothManager::instance().onConnection.trigger(&BluetoothManager::instance(),
-                                                      BluetoothManager::instance().createConnection());
+    uint16_t id = connInfo.getConnHandle();
+    auto *conn = ConnectionManager::connect(id) == CommonErrorCodes::None
+                 ? dynamic_cast<BluetoothConnection *>(ConnectionManager::getConnectionById(id)) : nullptr;
+    if (conn) {
+        conn->connect(id);
+        BluetoothManager::instance().onConnection.trigger(&BluetoothManager::instance(), conn);
+    } else {
+        pServer->disconnect(id);
+    }
 }
 
 void BluetoothServer::ServerCallbacks::onDisconnect(NimBLEServer* pServer, NimBLEConnInfo& connInfo, int reason) {
     // Delegate disconnection handling to the ConnectionManager
-    ConnectionManager::disconnect(connInfo.getAddress().getNative()[5]);
+    ConnectionManager::disconnect(connInfo.getConnHandle());
 }
 
 void BluetoothServer::SendDataCallbacks::onRead(NimBLECharacteristic* pCharacteristic, NimBLEConnInfo& connInfo) {
-    auto address = connInfo.getAddress();
-    auto *conn = ConnectionManager::getConnectionById(address.getNative()[5]);
+    auto *conn = dynamic_cast<BluetoothConnection *>(ConnectionManager::getConnectionById(connInfo.getConnHandle()));
     if (conn) {
         auto json = conn->getConnectionInfoJson();
         sendJson(pCharacteristic, json);
     } else {
-        ESP_LOGE("BluetoothServer", "Connection not found for ID: %d", address.getNative()[5]);
+        ESP_LOGE("BluetoothServer", "Connection not found for ID: %d", connInfo.getConnHandle());
     }
 }
 
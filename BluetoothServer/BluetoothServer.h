@@ -15,6 +15,17 @@
  * @brief Defines the BluetoothServer class for creating and managing a Bluetooth Low Energy (BLE) server.
  */
 
+#ifndef BLUETOOTH_MAX_CONNECTIONS
+/**
+ * @brief Connections preallocated by setup(), each with its own characteristics. Must fit CONNECTION_MAX_CONNECTIONS.
+ */
+#ifdef CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+#define BLUETOOTH_MAX_CONNECTIONS CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+#else
+#define BLUETOOTH_MAX_CONNECTIONS 3
+#endif
+#endif
+
 /**
  * @class BluetoothServer
  * @brief Singleton class representing the Bluetooth Low Energy server. 
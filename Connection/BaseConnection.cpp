@@ -1,11 +1,57 @@
 #include "BaseConnection.h"
 #include <esp_log.h>
+#include <cstdio>
 
 /**
  * @file BaseConnection.cpp
  * @brief Implementation of the BaseConnection class, providing common functionality for communication connections.
  */
 
+thread_local uint16_t RequestIdScope::_current = 0;
+thread_local ResponseBatchScope* ResponseBatchScope::_current = nullptr;
+
+/**
+ * Texto de erro escrito à mão ("ErrorMessage" ou "error"): vazio, falso, "None" ou a descrição de None não é erro.
+ */
+static ErrorCode ErrorFromText(const nlohmann::json& value) {
+    if (value.is_null() || (value.is_boolean() && !value.get<bool>())) return CommonErrorCodes::None;
+    if (value.is_string()) {
+        const auto& text = value.get_ref<const std::string&>();
+        if (text.empty() || text == CommonErrorCodes::None.name() || text == CommonErrorCodes::None.description()) {
+            return CommonErrorCodes::None;
+        }
+    }
+    return CommonErrorCodes::UnknownError;
+}
+
+/**
+ * Erro relatado por uma resposta JSON: o ErrorName dos modelos de JsonModels ou os campos de erro escritos à mão.
+ */
+static ErrorCode ErrorFromResponse(const nlohmann::json& response) {
+    auto name = response.find("ErrorName");
+    if (name != response.end() && name->is_string()) {
+        ErrorCode error = ErrorCode::get(name->get<std::string>());
+        if (error.isValid()) return error;
+    }
+    auto flag = response.find("Error");
+    if (flag != response.end() && flag->is_boolean() && flag->get<bool>()) return CommonErrorCodes::UnknownError;
+    for (const char* key: {"ErrorMessage", "error"}) {
+        auto text = response.find(key);
+        if (text == response.end()) continue;
+        ErrorCode error = ErrorFromText(*text);
+        if (error != CommonErrorCodes::None) return error;
+    }
+    return CommonErrorCodes::None;
+}
+
+void ResponseBatchScope::add(std::string_view json) {
+    _responses.emplace_back(json);
+    // Só o primeiro erro conta, e só vale analisar o que tem um campo de erro ("Error..." ou "error")
+    if (_error != CommonErrorCodes::None || json.find("rror") == std::string_view::npos) return;
+    auto response = nlohmann::json::parse(json, nullptr, false);
+    if (response.is_object()) fail(ErrorFromResponse(response));
+}
+
 BaseConnection::BaseConnection() : _notificationNeeds(NotificationNeeds::NoSend) {}
 
 ErrorCode BaseConnection::sendMessage(const std::string& message) const {
@@ -16,10 +62,35 @@ ErrorCode BaseConnection::sendMessage(const std::string& message) const {
     return sendRawData(reinterpret_cast<const uint8_t*>(message.c_str()), message.length());
 }
 
+ErrorCode BaseConnection::sendData(const ByteBuffer& data) const {
+    if (!isConnected()) {
+        return CommonErrorCodes::ConnectionClosed;
+    }
+
+    return sendRawData(data.data(), data.size());
+}
+
 ErrorCode BaseConnection::sendJson(const std::string& json) const {
     if (!isConnected()) {
         return CommonErrorCodes::ConnectionClosed;
     }
 
-    return sendRawData(reinterpret_cast<const uint8_t*>(json.c_str()), json.length());
+    std::string_view output = json;
+    std::string tagged;
+    uint16_t requestId = RequestIdScope::current();
+    if (requestId != 0 && json.size() >= 2 && json.front() == '{') {
+        // {"RequestId":N, + resto do objeto
+        char prefix[24];
+        int length = snprintf(prefix, sizeof(prefix), "{\"RequestId\":%u%s", requestId, json[1] == '}' ? "" : ",");
+        tagged.reserve(length + json.size() - 1);
+        tagged.append(prefix, length);
+        tagged.append(json, 1, std::string::npos);
+        output = tagged;
+    }
+
+    if (auto* batch = ResponseBatchScope::find(this)) {
+        batch->add(output);
+        return CommonErrorCodes::None;
+    }
+    return sendRawData(reinterpret_cast<const uint8_t*>(output.data()), output.length());
 }
\ No newline at end of file
@@ -1,12 +1,18 @@
 #ifndef BASECONNECTION_H
 #define BASECONNECTION_H
 
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "ErrorCode.h"
+#include "ByteBuffer.h"
 #include "Event.h"
 #include "CommonErrorCodes.h"
 #include "JsonModels.h"
+#include "CommandFrame.h"
+#include "TokenBucket.h"
 
 /**
  * @file BaseConnection.h
@@ -23,6 +29,109 @@ enum class NotificationNeeds {
     SendImportant /**< An important notification needs to be sent. */
 };
 
+/**
+ * @class RequestIdScope
+ * @brief Tags the JSON responses sent by the current task with a request id while it lives.
+ *
+ * Commander opens one around each handler it runs, so responses sent with sendJson(), sendError() or
+ * sendList() from inside the handler carry the id of the request that caused them and pipelined requests
+ * can be matched. The id is per task, so it does not follow work handed to other tasks.
+ */
+class RequestIdScope {
+public:
+    explicit RequestIdScope(uint16_t requestId) : _previous(_current) {
+        _current = requestId;
+    }
+
+    ~RequestIdScope() {
+        _current = _previous;
+    }
+
+    RequestIdScope(const RequestIdScope&) = delete;
+
+    RequestIdScope& operator=(const RequestIdScope&) = delete;
+
+    /**
+     * @brief Id of the request being answered by the current task, 0 if none.
+     */
+    static uint16_t current() {
+        return _current;
+    }
+
+private:
+    uint16_t _previous;
+    static thread_local uint16_t _current;
+};
+
+class BaseConnection;
+class ConnectedUser;
+
+/**
+ * @struct NotificationTopics
+ * @brief Notification topics of one connection, one bit per NotificationHub topic.
+ *
+ * Pending topics changed since they were last sent; updates to a topic still pending are merged into it.
+ */
+struct NotificationTopics {
+    std::atomic<uint32_t> subscribed{0}; /**< Topics the client wants. */
+    std::atomic<uint32_t> pending{0};    /**< Topics waiting to be sent. */
+};
+
+/**
+ * @class ResponseBatchScope
+ * @brief Collects the JSON responses the current task sends to one connection instead of sending them.
+ *
+ * Commander opens one around each command of a batch, so the whole batch is answered with a single write.
+ * Responses sent to other connections go out as usual.
+ */
+class ResponseBatchScope {
+public:
+    ResponseBatchScope(const BaseConnection* connection, std::vector<std::string>& responses)
+            : _previous(_current), _connection(connection), _responses(responses) {
+        _current = this;
+    }
+
+    ~ResponseBatchScope() {
+        _current = _previous;
+    }
+
+    ResponseBatchScope(const ResponseBatchScope&) = delete;
+
+    ResponseBatchScope& operator=(const ResponseBatchScope&) = delete;
+
+    /**
+     * @brief Scope collecting what the current task sends to the connection, or nullptr.
+     */
+    static ResponseBatchScope* find(const BaseConnection* connection) {
+        return _current != nullptr && _current->_connection == connection ? _current : nullptr;
+    }
+
+    /**
+     * @brief Keeps a response. Until the scope has an error, a response that reports one (ErrorName, a true
+     * Error, or an ErrorMessage/error other than None) also fails the scope, so handlers that build their own
+     * error JSON count too.
+     */
+    void add(std::string_view json);
+
+    /**
+     * @brief Keeps the first error, from sendError() or from a response given to add().
+     */
+    void fail(ErrorCode error) {
+        if (_error == CommonErrorCodes::None) _error = error;
+    }
+
+    [[nodiscard]] ErrorCode error() const {
+        return _error;
+    }
+
+private:
+    ResponseBatchScope* _previous;
+    const BaseConnection* _connection;
+    std::vector<std::string>& _responses;
+    ErrorCode _error = CommonErrorCodes::None;
+    static thread_local ResponseBatchScope* _current;
+};
+
 /**
  * @class BaseConnection
  * @brief Abstract base class for managing communication connections (e.g., WiFi, Bluetooth).
@@ -73,9 +182,20 @@ public:
      */
     ErrorCode sendMessage(const std::string& message) const;
 
+    /**
+     * @brief Sends a ByteBuffer over the connection, straight from its storage.
+     *
+     * @param data The payload to send.
+     * @return ErrorCode indicating success or failure of the send operation.
+     */
+    ErrorCode sendData(const ByteBuffer& data) const;
+
     /**
      * @brief Sends a JSON string over the connection.
      *
+     * Inside a RequestIdScope with a non-zero id, a JSON object gets "RequestId" as its first field.
+     * Inside a ResponseBatchScope for this connection the JSON is collected instead of sent.
+     *
      * @param json The JSON string to send.
      * @return ErrorCode indicating success or failure.
      */
@@ -127,6 +247,66 @@ public:
      */
     void setNotificationNeeds(NotificationNeeds needs);
 
+    /**
+     * @brief Gets how the commands received on this connection are framed.
+     *
+     * @return The current command framing, Text until the client asks for Binary.
+     */
+    [[nodiscard]] CommandFraming getCommandFraming() const;
+
+    /**
+     * @brief Sets how the commands received on this connection are framed.
+     *
+     * @param framing The framing used by the following packets.
+     */
+    void setCommandFraming(CommandFraming framing);
+
+    /**
+     * @brief Gets the rate budget of the commands received on this connection.
+     *
+     * Commander spends and refills it under its own lock, with the rate it was configured with.
+     *
+     * @return The token bucket of this connection.
+     */
+    TokenBucket& getCommandTokens();
+
+    /**
+     * @brief Gets the notification topics of this connection.
+     *
+     * NotificationHub updates them; use NotificationHub::subscribe() to change the subscriptions.
+     *
+     * @return The topics of this connection.
+     */
+    NotificationTopics& getNotificationTopics();
+
+    /**
+     * @brief Gets the user logged in on this connection.
+     *
+     * @return The user, or nullptr if nobody logged in.
+     */
+    [[nodiscard]] ConnectedUser* getUser() const;
+
+    /**
+     * @brief Sets the user logged in on this connection. UserManager sets it on login, on any transport.
+     *
+     * @param user The logged in user.
+     */
+    void setUser(ConnectedUser* user);
+
+    /**
+     * @brief Forgets the user of this connection. The user itself is released by UserManager.
+     */
+    void logoff();
+
+    /**
+     * @brief Clears the state left by the last client (framing, rate budget, notification needs and topics).
+     *
+     * ConnectionManager calls it when the connection goes back to the free list, so the same object can
+     * serve the next client without being reallocated. The user is left alone: UserManager releases it from
+     * its own onDisconnect handler.
+     */
+    void recycle();
+
     /**
      * @brief Event triggered when the connection is disconnected.
      */
@@ -134,6 +314,10 @@ public:
 
 protected:
     NotificationNeeds _notificationNeeds; /**< The current notification needs of the connection. */
+    CommandFraming _commandFraming = CommandFraming::Text; /**< How received commands are framed. */
+    TokenBucket _commandTokens; /**< Rate budget of the received commands. */
+    NotificationTopics _notificationTopics; /**< Subscribed and pending notification topics. */
+    ConnectedUser* _user = nullptr; /**< User logged in on this connection, if any. */
 };
 
 // Template Method Implementations
@@ -144,6 +328,9 @@ ErrorCode BaseConnection::sendError(ErrorCode errorCode) const {
 
     if (errorCode != CommonErrorCodes::None) {
         ESP_LOGE(__FUNCTION__, "Error: %s - %s", errorCode.name().c_str(), errorCode.description().c_str());
+        if (auto* batch = ResponseBatchScope::find(this)) {
+            batch->fail(errorCode);
+        }
     }
 
     TModel jsonData;
@@ -199,4 +386,40 @@ inline void BaseConnection::setNotificationNeeds(NotificationNeeds needs) {
     _notificationNeeds = needs;
 }
 
+inline CommandFraming BaseConnection::getCommandFraming() const {
+    return _commandFraming;
+}
+
+inline void BaseConnection::setCommandFraming(CommandFraming framing) {
+    _commandFraming = framing;
+}
+
+inline TokenBucket& BaseConnection::getCommandTokens() {
+    return _commandTokens;
+}
+
+inline NotificationTopics& BaseConnection::getNotificationTopics() {
+    return _notificationTopics;
+}
+
+inline ConnectedUser* BaseConnection::getUser() const {
+    return _user;
+}
+
+inline void BaseConnection::setUser(ConnectedUser* user) {
+    _user = user;
+}
+
+inline void BaseConnection::logoff() {
+    _user = nullptr;
+}
+
+inline void BaseConnection::recycle() {
+    _notificationNeeds = NotificationNeeds::NoSend;
+    _commandFraming = CommandFraming::Text;
+    _commandTokens.reset();
+    _notificationTopics.subscribed.store(0, std::memory_order_relaxed);
+    _notificationTopics.pending.store(0, std::memory_order_relaxed);
+}
+
 #endif // BASECONNECTION_H
\ No newline at end of file
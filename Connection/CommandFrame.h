@@ -0,0 +1,148 @@
+#ifndef COMMANDFRAME_H
+#define COMMANDFRAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+/**
+ * Código reservado que troca o enquadramento da conexão. No texto: código seguido de "binary" ou "text";
+ * no binário: um quadro com esse código e um argumento "text" ou "binary".
+ */
+#ifndef COMMAND_FRAMING_CODE
+#define COMMAND_FRAMING_CODE 0xFF
+#endif
+
+/**
+ * Código reservado de um lote: vários comandos num pacote só, executados em ordem e respondidos com um
+ * BatchResultJson. No texto: código, modo ("stop", "len", "stop:len" ou vazio) e um comando por linha, ou
+ * "<tamanho>:<bytes>" com "len" (para comandos que contêm '\n'); no binário: um quadro com esse código e cada
+ * comando, já enquadrado, como argumento.
+ */
+#ifndef COMMAND_BATCH_CODE
+#define COMMAND_BATCH_CODE 0xFE
+#endif
+
+/**
+ * Flags do cabeçalho do quadro, combináveis com |.
+ */
+enum CommandFrameFlags : uint8_t {
+    CommandFrameFlagNone = 0,
+    CommandFrameFlagStopOnError = 1 << 0, /**< Lote: para no primeiro comando com erro */
+};
+
+/**
+ * Como a conexão envia os comandos.
+ */
+enum class CommandFraming : uint8_t {
+    Text,   /**< Código seguido de argumentos separados por ':' (padrão) */
+    Binary  /**< Quadro CommandFrame */
+};
+
+/**
+ * Argumento de um quadro binário. O tipo é da aplicação, o Commander só o repassa; no texto é sempre 0.
+ */
+struct CommandFrameArg {
+    uint8_t Type;
+    std::string_view Value;
+};
+
+/**
+ * Quadro binário de comando, lido sobre o buffer recebido sem copiar:
+ *
+ *     código (1) | flags (1) | id do pedido (2, little-endian) | argumentos
+ *     argumento: tipo (1) | tamanho (2, little-endian) | valor
+ *
+ * Os argumentos podem conter qualquer byte, inclusive ':' e '\0'.
+ */
+class CommandFrame {
+public:
+    static constexpr size_t HeaderSize = 4;
+    static constexpr size_t ArgHeaderSize = 3;
+
+    /**
+     * Confere o quadro inteiro. Retorna false se estiver truncado ou um argumento passar do fim.
+     */
+    bool parse(std::string_view packet) {
+        if (packet.size() < HeaderSize) return false;
+        _code = static_cast<uint8_t>(packet[0]);
+        _flags = static_cast<uint8_t>(packet[1]);
+        _requestId = static_cast<uint16_t>(static_cast<uint8_t>(packet[2]) | static_cast<uint8_t>(packet[3]) << 8);
+        _args = packet.substr(HeaderSize);
+        _count = 0;
+
+        std::string_view rest = _args;
+        CommandFrameArg arg{};
+        while (readArg(rest, arg)) _count++;
+        _cursor = _args;
+        return rest.empty();
+    }
+
+    uint8_t code() const {
+        return _code;
+    }
+
+    uint8_t flags() const {
+        return _flags;
+    }
+
+    uint16_t requestId() const {
+        return _requestId;
+    }
+
+    size_t count() const {
+        return _count;
+    }
+
+    /**
+     * Lê o próximo argumento. O valor aponta para o buffer do quadro.
+     */
+    bool next(CommandFrameArg &arg) {
+        return readArg(_cursor, arg);
+    }
+
+    /**
+     * Monta um quadro, para clientes e testes. Argumentos maiores que 65535 bytes são truncados.
+     */
+    static std::string build(uint8_t code, uint16_t requestId, std::initializer_list<CommandFrameArg> args,
+                             uint8_t flags = 0) {
+        std::string frame;
+        size_t size = HeaderSize;
+        for (const auto &arg: args) size += ArgHeaderSize + arg.Value.size();
+        frame.reserve(size);
+        frame.push_back(static_cast<char>(code));
+        frame.push_back(static_cast<char>(flags));
+        frame.push_back(static_cast<char>(requestId & 0xFF));
+        frame.push_back(static_cast<char>(requestId >> 8));
+        for (const auto &arg: args) {
+            auto length = static_cast<uint16_t>(arg.Value.size() > UINT16_MAX ? UINT16_MAX : arg.Value.size());
+            frame.push_back(static_cast<char>(arg.Type));
+            frame.push_back(static_cast<char>(length & 0xFF));
+            frame.push_back(static_cast<char>(length >> 8));
+            frame.append(arg.Value.data(), length);
+        }
+        return frame;
+    }
+
+private:
+    static bool readArg(std::string_view &rest, CommandFrameArg &arg) {
+        if (rest.size() < ArgHeaderSize) return false;
+        size_t length = static_cast<uint8_t>(rest[1]) | static_cast<uint8_t>(rest[2]) << 8;
+        if (rest.size() - ArgHeaderSize < length) return false;
+        arg.Type = static_cast<uint8_t>(rest[0]);
+        arg.Value = rest.substr(ArgHeaderSize, length);
+        rest.remove_prefix(ArgHeaderSize + length);
+        return true;
+    }
+
+    std::string_view _args;
+    std::string_view _cursor;
+    size_t _count = 0;
+    uint16_t _requestId = 0;
+    uint8_t _code = 0;
+    uint8_t _flags = 0;
+};
+
+#endif //COMMANDFRAME_H
@@ -2,77 +2,646 @@
 // Created by maikeu on 18/08/2019.
 //
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <cstdio>
 #include <esp_log.h>
-#include <sstream>
 #include <Utility.h>
+#include <Tokenizer.h>
+#include <DeferredLog.h>
+#include <Trace.h>
+#include <Metrics.h>
 #include <priorities.h>
 #include "Commander.h"
+#include "ConnectionManager.h"
+#include "CommonErrorCodes.h"
 #include "vector"
 
-typedef struct Command_s {//NOLINT
-    std::function<void(const std::vector<std::string> &, BaseConnection *)> Function{};
-    std::vector<std::string> Data;
+/**
+ * Comando recebido aguardando execução. O handler é referenciado, não copiado:
+ * os elementos de Commander::_commands não mudam de endereço.
+ */
+struct CommandEnvelope {
+    const DeviceCommand *Command{};
+    uint32_t FlowId{}; /**< Liga no trace a recepção à execução */
+    int64_t Received{}; /**< Instante em que entrou na fila, em µs */
+    uint16_t RequestId{}; /**< Id do pedido no quadro binário, 0 no texto */
+    uint8_t Flags{}; /**< CommandFrameFlags do quadro, ou o modo do lote no texto */
+    bool Binary{}; /**< Lote: os comandos são quadros binários, senão linhas de texto */
     BaseConnection *Connection{};
-} Command_t;
+    /**
+     * Cliente que enviou o comando. A conexão do pool é reciclada para o próximo cliente, então é o handle que
+     * diz se quem pediu ainda está lá; não válido para conexões fora do pool, que não são recicladas.
+     */
+    ConnectionHandle Handle{};
+    CommandArgs Args;
+};
 
-static QueueHandle_t xCommandQueue = xQueueCreate(10, sizeof(void *));//NOLINT
+static CommandEnvelope envelopes[COMMAND_POOL_SIZE];//NOLINT
+static_assert(COMMAND_POOL_SIZE <= UINT8_MAX, "COMMAND_POOL_SIZE must fit in uint8_t");
 
-static void CommandExecutorTask(void *arg __unused) {
+// Lanes rápidas 0..COMMAND_WORKERS-1, cada uma com sua tarefa, e a lenta por último
+static constexpr uint8_t SlowLane = COMMAND_WORKERS;
+static constexpr uint8_t LaneCount = COMMAND_WORKERS + 1;
+
+// As filas carregam índices de envelopes; as das lanes nunca enchem, pois só existem COMMAND_POOL_SIZE envelopes
+static QueueHandle_t xFreeEnvelopes = [] {//NOLINT
+    auto queue = xQueueCreate(COMMAND_POOL_SIZE, sizeof(uint8_t));
+    for (uint8_t i = 0; i < COMMAND_POOL_SIZE; i++) {
+        xQueueSendToBack(queue, &i, 0);
+    }
+    return queue;
+}();
+static QueueHandle_t xLaneQueues[LaneCount] = {};//NOLINT
+static const bool lanesCreated = [] {//NOLINT
+    for (auto &queue: xLaneQueues) {
+        queue = xQueueCreate(COMMAND_POOL_SIZE, sizeof(uint8_t));
+    }
+    return true;
+}();
+static std::atomic<uint32_t> rejectedCommands{0};
+static std::atomic<uint32_t> throttledCommands{0};
+static std::atomic<uint32_t> droppedCommands{0};
+static uint16_t ratePerSecond = COMMAND_RATE_PER_SECOND;//NOLINT
+static uint16_t rateBurst = COMMAND_RATE_BURST;//NOLINT
+
+/**
+ * Comandos de uma conexão na fila ou em execução. Enquanto houver algum, os próximos vão para a mesma lane:
+ * é isso que mantém a ordem por conexão. Nunca há mais conexões pendentes que envelopes.
+ * A entrada é do cliente (conexão e handle): o próximo cliente da mesma conexão do pool começa numa entrada nova.
+ */
+struct PendingConnection {
+    BaseConnection *Connection;
+    ConnectionHandle Handle;
+    uint8_t Count;
+    uint8_t Lane;
+    uint8_t Codes[COMMAND_MAX_PENDING_PER_CONNECTION]; /**< Códigos pendentes, os Count primeiros */
+};
+
+// Motivos de recusa de AcquireLane
+static constexpr int LaneFull = -1;
+static constexpr int LaneThrottled = -2;
+
+static PendingConnection pendingConnections[COMMAND_POOL_SIZE];//NOLINT
+static portMUX_TYPE pendingMux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * Reserva a vez de mais um comando da conexão e gasta as fichas dele. Retorna a lane, LaneFull se a conexão já tem
+ * COMMAND_MAX_PENDING_PER_CONNECTION comandos (ou maxInFlight com o código) pendentes, ou LaneThrottled se faltarem
+ * fichas no balde da conexão. Recusado, nada é gasto.
+ */
+static int AcquireLane(BaseConnection *connection, ConnectionHandle handle, uint8_t code, bool slow,
+                       uint8_t maxInFlight, uint32_t cost) {
+    PendingConnection *entry = nullptr;
+    PendingConnection *freeEntry = nullptr;
+    uint8_t load[LaneCount] = {};
+    int64_t now = Metrics::now();
+
+    portENTER_CRITICAL(&pendingMux);
+    for (auto &pending: pendingConnections) {
+        if (pending.Count == 0) {
+            if (freeEntry == nullptr) freeEntry = &pending;
+            continue;
+        }
+        load[pending.Lane] += pending.Count;
+        if (pending.Connection == connection && pending.Handle == handle) entry = &pending;
+    }
+
+    int lane = LaneFull;
+    if (entry != nullptr) {
+        uint8_t sameCode = 0;
+        for (uint8_t i = 0; i < entry->Count; i++) {
+            if (entry->Codes[i] == code) sameCode++;
+        }
+        if (entry->Count < COMMAND_MAX_PENDING_PER_CONNECTION && (maxInFlight == 0 || sameCode < maxInFlight)) {
+            lane = entry->Lane;
+        }
+    } else if (freeEntry != nullptr) {
+        // Conexão sem pendências: lane lenta ou a rápida menos ocupada
+        lane = slow ? SlowLane : 0;
+        for (uint8_t i = 1; !slow && i < COMMAND_WORKERS; i++) {
+            if (load[i] < load[lane]) lane = i;
+        }
+    }
+    if (lane >= 0 && connection != nullptr && cost > 0 &&
+        !connection->getCommandTokens().tryTake(cost, ratePerSecond, rateBurst, now)) {
+        lane = LaneThrottled;
+    }
+    if (lane >= 0) {
+        if (entry == nullptr) {
+            entry = freeEntry;
+            *entry = {connection, handle, 0, static_cast<uint8_t>(lane), {}};
+        }
+        entry->Codes[entry->Count++] = code;
+    }
+    portEXIT_CRITICAL(&pendingMux);
+    return lane;
+}
+
+static void ReleaseLane(BaseConnection *connection, ConnectionHandle handle, uint8_t code) {
+    portENTER_CRITICAL(&pendingMux);
+    for (auto &pending: pendingConnections) {
+        if (pending.Count > 0 && pending.Connection == connection && pending.Handle == handle) {
+            // Tira uma ocorrência do código, mantendo os pendentes nas primeiras posições
+            for (uint8_t i = 0; i < pending.Count; i++) {
+                if (pending.Codes[i] == code) {
+                    pending.Codes[i] = pending.Codes[pending.Count - 1];
+                    break;
+                }
+            }
+            pending.Count--;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&pendingMux);
+}
+
+/**
+ * Lote recebido com COMMAND_BATCH_CODE. Não fica na tabela: o executor o reconhece pelo endereço.
+ */
+static const DeviceCommand BatchCommand(0, "Batch", COMMAND_BATCH_CODE, //NOLINT
+                                        std::function<void(const CommandArgs &, BaseConnection *)>(),
+                                        CommandFlagAnyArgs);
+
+static void RunHandler(const DeviceCommand &command, const CommandArgs &args, BaseConnection *connection) {
+    if (command.ArgsFunction) {
+        command.ArgsFunction(args, connection);
+    } else {
+        command.Function(args.toVector(), connection);
+    }
+}
+
+/**
+ * Confere o número de argumentos e os copia para args, do quadro (já lido com parse()) ou do texto.
+ */
+static ErrorCode ReadArgs(const DeviceCommand &command, bool binary, CommandFrame &frame, Tokenizer &tokenizer,
+                          CommandArgs &args) {
+    auto dataSize = binary ? frame.count() : tokenizer.count();
+    if (dataSize != command.DataSize && !(command.Flags & CommandFlagAnyArgs)) {
+        ESP_LOGW(__FUNCTION__,
+                 "Número de argumentos recebidos %d diferente do esperado %lu", static_cast<int>(dataSize),
+                 static_cast<unsigned long>(command.DataSize));
+        return CommonErrorCodes::ArgumentError;
+    }
+
+    bool fits = true;
+    if (binary) {
+        CommandFrameArg arg{};
+        while (fits && frame.next(arg)) fits = args.append(arg.Value, arg.Type);
+    } else {
+        std::string_view token;
+        while (fits && tokenizer.next(token)) fits = args.append(token);
+    }
+    if (!fits) {
+        ESP_LOGW(__FUNCTION__, "Argumentos do comando %s excedem %d bytes", command.InternalName.c_str(),
+                 COMMAND_ARGS_CAPACITY);
+        args.clear();
+        return CommonErrorCodes::ArgumentError;
+    }
+    return CommonErrorCodes::None;
+}
+
+/**
+ * Lote em texto: um comando por linha, copiado sem decodificar, pois cada linha é lida de novo ao executar.
+ * Linhas vazias são ignoradas. Um comando com '\n' no código ou nos argumentos precisa do modo "len".
+ */
+static bool ReadBatchLines(std::string_view rxData, CommandArgs &args) {
+    while (!rxData.empty()) {
+        auto end = rxData.find('\n');
+        auto line = rxData.substr(0, end);
+        rxData.remove_prefix(end == std::string_view::npos ? rxData.size() : end + 1);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (!line.empty() && !args.append(line, 0)) return false;
+    }
+    return true;
+}
+
+/**
+ * Lote em texto no modo "len": cada comando vem como "<tamanho>:<bytes>", então pode conter '\n' (no código ou
+ * nos argumentos). Um '\n' (ou "\r\n") entre os comandos é opcional. Tamanho vazio, zero, com algo além de
+ * dígitos ou passando do fim do pacote é recusado.
+ */
+static bool ReadBatchLengthPrefixed(std::string_view rxData, CommandArgs &args) {
+    while (!rxData.empty()) {
+        if (rxData.front() == '\r') rxData.remove_prefix(1);
+        if (!rxData.empty() && rxData.front() == '\n') {
+            rxData.remove_prefix(1);
+            continue;
+        }
+        auto colon = rxData.find(':');
+        if (colon == 0 || colon == std::string_view::npos) return false;
+        size_t length = 0;
+        for (char digit: rxData.substr(0, colon)) {
+            // Parar no que passa do pacote também evita estourar length
+            if (digit < '0' || digit > '9' || length > rxData.size()) return false;
+            length = length * 10 + (digit - '0');
+        }
+        rxData.remove_prefix(colon + 1);
+        if (length == 0 || length > rxData.size() || !args.append(rxData.substr(0, length), 0)) return false;
+        rxData.remove_prefix(length);
+    }
+    return true;
+}
+
+/**
+ * Executa um comando do lote, guardando em responses o que ele envia à conexão.
+ */
+static ErrorCode RunBatchItem(std::string_view packet, bool binary, BaseConnection *connection,
+                              std::vector<std::string> &responses) {
+    CommandFrame frame;
+    bool valid = binary ? frame.parse(packet) : !packet.empty();
+    uint8_t code = valid ? (binary ? frame.code() : static_cast<uint8_t>(packet[0])) : 0;
+    RequestIdScope requestId(valid && binary ? frame.requestId() : 0);
+    ResponseBatchScope batch(connection, responses);
+
+    // Os códigos reservados nunca estão na tabela: lotes não se aninham
+    const DeviceCommand *command = valid ? Commander::FindCommand(code) : nullptr;
+    CommandArgs args;
+    Tokenizer tokenizer(binary || packet.empty() ? std::string_view() : packet.substr(1), ':');
+    ErrorCode error = !valid ? CommonErrorCodes::ArgumentError
+                             : command == nullptr ? CommonErrorCodes::InvalidCommand
+                                                  : ReadArgs(*command, binary, frame, tokenizer, args);
+    if (error != CommonErrorCodes::None) {
+        JsonModels::CommandResultJson result;
+        result.Command = code;
+        result.ErrorMessage = error;
+        connection->sendJson(result.toJson());
+        return error;
+    }
+
+    TraceSpan span(command->InternalName.c_str(), "command");
+    RunHandler(*command, args, connection);
+    return batch.error();
+}
+
+/**
+ * Conexão do cliente que enviou o comando, ou nullptr se ele já se desconectou (a conexão do pool pode até estar
+ * servindo outro cliente).
+ */
+static BaseConnection *ResolveConnection(BaseConnection *connection, ConnectionHandle handle) {
+    return handle.valid() ? ConnectionManager::getConnection(handle) : connection;
+}
+
+/**
+ * Executa os comandos do lote em ordem e responde uma vez, com tudo o que eles enviaram.
+ * O erro do lote é o primeiro erro de um comando.
+ */
+static void RunBatch(const CommandEnvelope &envelope, BaseConnection *connection) {
+    JsonModels::BatchResultJson result;
+    result.Command = COMMAND_BATCH_CODE;
+    result.Results.reserve(envelope.Args.size());
+    for (size_t i = 0; i < envelope.Args.size(); i++) {
+        ErrorCode error = RunBatchItem(envelope.Args[i], envelope.Binary, connection, result.Results.emplace_back());
+        result.Executed++;
+        if (error == CommonErrorCodes::None) continue;
+        if (result.ErrorMessage == CommonErrorCodes::None) result.ErrorMessage = error;
+        if (envelope.Flags & CommandFrameFlagStopOnError) break;
+    }
+    connection->sendJson(result.toJson());
+}
+
+static void CommandExecutorTask(void *arg) {
+    static Histogram &latency = Metrics::histogram("command.latency_us");
+    static Gauge &queueDepth = Metrics::gauge("command.queue_depth");
+    static Counter &stale = Metrics::counter("command.stale");
+    auto lane = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(arg));
     for (;;) {
-        Command_t *command = nullptr;
-        if (xQueueReceive(xCommandQueue, &command, portMAX_DELAY) == pdPASS) {
-            command->Function(command->Data, command->Connection);
-            delete command;
+        uint8_t index;
+        if (xQueueReceive(xLaneQueues[lane], &index, portMAX_DELAY) == pdPASS) {
+            auto &envelope = envelopes[index];
+            BaseConnection *connection = ResolveConnection(envelope.Connection, envelope.Handle);
+            if (connection == nullptr && envelope.Connection != nullptr) {
+                // Quem pediu saiu enquanto o comando esperava: não executa nem responde ao cliente que veio depois
+                stale.increment();
+                DLOGW(__FUNCTION__, "Comando %s descartado: cliente desconectado",
+                      envelope.Command->InternalName.c_str());
+            } else {
+                TraceSpan span(envelope.Command->InternalName.c_str(), "command");
+                RequestIdScope requestId(envelope.RequestId);
+                Trace::flowEnd("command", envelope.FlowId);
+                if (envelope.Command == &BatchCommand) {
+                    RunBatch(envelope, connection);
+                } else {
+                    RunHandler(*envelope.Command, envelope.Args, connection);
+                }
+            }
+            // Da entrada na fila até o fim do handler
+            latency.record(static_cast<uint32_t>(Metrics::now() - envelope.Received));
+            ReleaseLane(envelope.Connection, envelope.Handle, envelope.Command->Code);
+            envelope.Command = nullptr;
+            envelope.Connection = nullptr;
+            envelope.Handle = {};
+            envelope.Args.clear();
+            xQueueSendToBack(xFreeEnvelopes, &index, 0);
+            queueDepth.set(static_cast<int32_t>(COMMAND_POOL_SIZE - uxQueueMessagesWaiting(xFreeEnvelopes)));
         }
     }
 }
 
+/**
+ * Avisa a conexão que o comando foi recusado por sobrecarga, em vez de deixá-la esperando uma resposta.
+ */
+static void RejectBusy(BaseConnection *connection, const DeviceCommand &command, bool throttled, const char *reason) {
+    static Counter &busy = Metrics::counter("command.busy");
+    static Counter &throttledCounter = Metrics::counter("command.throttled");
+    static Counter &droppedCounter = Metrics::counter("command.dropped");
+    rejectedCommands.fetch_add(1, std::memory_order_relaxed);
+    (throttled ? throttledCommands : droppedCommands).fetch_add(1, std::memory_order_relaxed);
+    busy.increment();
+    (throttled ? throttledCounter : droppedCounter).increment();
+    ESP_LOGW(__FUNCTION__, "Comando %s recusado: %s", command.InternalName.c_str(), reason);
+    if (connection == nullptr) return;
+    JsonModels::CommandResultJson result;
+    result.Command = command.Code;
+    result.ErrorMessage = CommonErrorCodes::Busy;
+    connection->sendJson(result.toJson());
+}
+
+bool CommandArgs::append(std::string_view token) {
+    if (_count >= COMMAND_MAX_ARGS) return false;
+    size_t start = _offsets[_count];
+    size_t length = Tokenizer::decode(token, _data + start, COMMAND_ARGS_CAPACITY - start);
+    if (start + length > COMMAND_ARGS_CAPACITY) return false;
+    _types[_count] = 0;
+    _offsets[++_count] = start + length;
+    return true;
+}
+
+bool CommandArgs::append(std::string_view value, uint8_t type) {
+    if (_count >= COMMAND_MAX_ARGS) return false;
+    size_t start = _offsets[_count];
+    if (value.size() > COMMAND_ARGS_CAPACITY - start) return false;
+    memcpy(_data + start, value.data(), value.size());
+    _types[_count] = type;
+    _offsets[++_count] = start + value.size();
+    return true;
+}
+
+/**
+ * Troca o enquadramento da conexão e responde com o resultado.
+ */
+static ErrorCode SetFraming(BaseConnection *connection, std::string_view mode) {
+    if (connection == nullptr) return CommonErrorCodes::ArgumentError;
+    JsonModels::CommandResultJson result;
+    result.Command = COMMAND_FRAMING_CODE;
+    if (mode == "binary") {
+        connection->setCommandFraming(CommandFraming::Binary);
+    } else if (mode == "text") {
+        connection->setCommandFraming(CommandFraming::Text);
+    } else {
+        result.ErrorMessage = CommonErrorCodes::ArgumentError;
+    }
+    connection->sendJson(result.toJson());
+    return result.ErrorMessage;
+}
+
+/**
+ * Reserva um envelope livre. Sem nenhum, responde Busy à conexão e retorna false.
+ */
+static bool AcquireEnvelope(BaseConnection *connection, const DeviceCommand &command, uint8_t &index) {
+    if (xQueueReceive(xFreeEnvelopes, &index, 0) == pdPASS) return true;
+    RejectBusy(connection, command, false, "sem envelope livre");
+    return false;
+}
+
+static void ReleaseEnvelope(uint8_t index) {
+    envelopes[index].Args.clear();
+    xQueueSendToBack(xFreeEnvelopes, &index, 0);
+}
+
 void Commander::Init() {
-    Utility::CreateAndProfile("CommandExecutorTask", CommandExecutorTask, 8192, HIGH_PRIORITY, 0, nullptr);
+    static bool started = false;
+    if (started || !lanesCreated) return;
+    started = true;
+    DeferredLog::start();
+    // Uma tarefa por lane rápida, alternando os núcleos; a lenta fica no último, com prioridade menor
+    char name[configMAX_TASK_NAME_LEN];
+    for (uint8_t lane = 0; lane < COMMAND_WORKERS; lane++) {
+        snprintf(name, sizeof(name), "CommandWorker%u", lane);
+        Utility::CreateAndProfile(name, CommandExecutorTask, COMMAND_WORKER_STACK, HIGH_PRIORITY,
+                                  lane % portNUM_PROCESSORS, reinterpret_cast<void *>(lane));
+    }
+    Utility::CreateAndProfile("CommandSlowWorker", CommandExecutorTask, COMMAND_WORKER_STACK, MEDIUM_PRIORITY,
+                              portNUM_PROCESSORS - 1, reinterpret_cast<void *>(SlowLane));
+}
+
+uint32_t Commander::GetRejectedCount() {
+    return rejectedCommands.load(std::memory_order_relaxed);
+}
+
+uint32_t Commander::GetThrottledCount() {
+    return throttledCommands.load(std::memory_order_relaxed);
+}
+
+uint32_t Commander::GetDroppedCount() {
+    return droppedCommands.load(std::memory_order_relaxed);
+}
+
+void Commander::SetLimit(uint8_t code, CommandLimit limit) {
+    if (limit.Cost > rateBurst) {
+        ESP_LOGW(__FUNCTION__, "Custo %u do codigo %u maior que o balde (%u): o comando nunca passa", limit.Cost,
+                 code, rateBurst);
+    }
+    _limits[code] = limit;
+}
+
+void Commander::SetRate(uint16_t perSecond, uint16_t burst) {
+    ratePerSecond = perSecond;
+    rateBurst = burst;
 }
 
 void Commander::AddCommand(const DeviceCommand& command) {
-    for (const auto& comm : _commands) {
-        if (comm.Code == command.Code) {
-            ESP_LOGE(__FUNCTION__, "Codigo %u, para o comando %s, ja utilizado pelo comando %s", comm.Code,
-                     command.InternalName.c_str(), comm.InternalName.c_str());
-            return;
-        }
+    if (command.Code == COMMAND_FRAMING_CODE || command.Code == COMMAND_BATCH_CODE) {
+        ESP_LOGE(__FUNCTION__, "Codigo %u, para o comando %s, reservado pelo Commander", command.Code,
+                 command.InternalName.c_str());
+        return;
     }
+    const DeviceCommand *existing = _table[command.Code];
+    if (existing != nullptr) {
+        ESP_LOGE(__FUNCTION__, "Codigo %u, para o comando %s, ja utilizado pelo comando %s", existing->Code,
+                 command.InternalName.c_str(), existing->InternalName.c_str());
+        return;
+    }
+    // A lista guarda os comandos (endereços estáveis), a tabela só aponta para eles
     _commands.push_back(command);
+    _table[command.Code] = &_commands.back();
+}
+
+const DeviceCommand *Commander::FindCommand(uint8_t code) {
+    return _table[code];
+}
+
+const DeviceCommand *Commander::FindCommand(std::string_view name) {
+    for (const auto &command: _commands) {
+        const auto &internalName = command.InternalName;
+        if (internalName.size() == name.size() &&
+            std::equal(name.begin(), name.end(), internalName.begin(), [](unsigned char a, unsigned char b) {
+                return std::tolower(a) == std::tolower(b);
+            })) {
+            return &command;
+        }
+    }
+    return nullptr;
+}
+
+const std::list<DeviceCommand> &Commander::GetCommands() {
+    return _commands;
 }
 
 std::list<DeviceCommand> Commander::_commands;//NOLINT
+std::array<const DeviceCommand *, COMMAND_CODE_COUNT> Commander::_table{};//NOLINT
+std::array<CommandLimit, COMMAND_CODE_COUNT> Commander::_limits{};//NOLINT
+
+ErrorCode Commander::CheckForCommand(const std::string &rxValue, BaseConnection *connection) {
+    TraceSpan span("Commander::CheckForCommand", "command");
+    if (rxValue.empty()) return CommonErrorCodes::InvalidCommand;
+    bool binary = connection != nullptr && connection->getCommandFraming() == CommandFraming::Binary;
 
-void Commander::CheckForCommand(const std::string &rxValue, BaseConnection *connection) {
     //Extrai comando
-    uint8_t commandCode = rxValue.c_str()[0];
-    auto rxData = std::string(rxValue.c_str() + 1);
-    auto data = Utility::split(rxData, ':');
-    ESP_LOGI(__FUNCTION__, "Command: %u", commandCode);
-    std::stringstream printData;
-    for (const auto &d : data) {
-        printData << d << " | ";
-    }
-    if (printData.str().size() > 1) {
-        ESP_LOGI(__FUNCTION__, "Data : %s", printData.str().c_str());
-    }
-
-    for (const auto& command : _commands) {
-        if (command.Code == commandCode) {
-            ESP_LOGI(__FUNCTION__, "Comando encontrado: %s", command.InternalName.c_str());
-            if (data.size() != command.DataSize) {
-                ESP_LOGW(__FUNCTION__,
-                         "Número de argumentos recebidos %d diferente do esperado %ld", data.size(),
-                         command.DataSize);
-                return;
+    CommandFrame frame;
+    uint8_t commandCode;
+    std::string_view rxData;
+    if (binary) {
+        if (!frame.parse(rxValue)) {
+            ESP_LOGW(__FUNCTION__, "Quadro binario invalido, %u bytes", static_cast<unsigned>(rxValue.size()));
+            return CommonErrorCodes::ArgumentError;
+        }
+        commandCode = frame.code();
+        rxData = std::string_view(rxValue).substr(CommandFrame::HeaderSize);
+    } else {
+        commandCode = rxValue[0];
+        rxData = std::string_view(rxValue).substr(1);
+        ESP_LOGD(__FUNCTION__, "Data : %.*s", static_cast<int>(rxData.size()), rxData.data());
+    }
+    // Respostas dadas aqui mesmo (enquadramento, Busy) também levam o id do pedido
+    RequestIdScope requestId(binary ? frame.requestId() : 0);
+
+    if (commandCode == COMMAND_FRAMING_CODE) {
+        CommandFrameArg mode{};
+        if (binary) frame.next(mode);
+        return SetFraming(connection, binary ? mode.Value : rxData);
+    }
+
+    uint8_t flags = binary ? frame.flags() : static_cast<uint8_t>(CommandFrameFlagNone);
+    bool batch = commandCode == COMMAND_BATCH_CODE;
+    if (batch && connection == nullptr) return CommonErrorCodes::ArgumentError;
+    bool lengthPrefixed = false;
+    if (batch && !binary) {
+        // Primeira linha do lote: opções separadas por ':', "stop" para no primeiro erro e "len" traz os comandos
+        // com o tamanho na frente; vazia executa tudo, um por linha
+        auto end = rxData.find('\n');
+        Tokenizer mode(rxData.substr(0, end), ':');
+        std::string_view option;
+        while (mode.next(option)) {
+            if (option == "stop") {
+                flags |= CommandFrameFlagStopOnError;
+            } else if (option == "len") {
+                lengthPrefixed = true;
+            } else if (!option.empty()) {
+                return CommonErrorCodes::ArgumentError;
             }
-            auto *commandToSend = new Command_t;
-            commandToSend->Function = command.Function;
-            commandToSend->Data = data;
-            commandToSend->Connection = connection;
-            xQueueSendToBack(xCommandQueue, &commandToSend, portMAX_DELAY);
         }
+        rxData = end == std::string_view::npos ? std::string_view() : rxData.substr(end + 1);
+    }
+
+    const DeviceCommand *found = batch ? &BatchCommand : _table[commandCode];
+    if (found == nullptr) {
+        DLOGW(__FUNCTION__, "Comando %u desconhecido", commandCode);
+        return CommonErrorCodes::InvalidCommand;
+    }
+    const auto &command = *found;
+
+    // Os nomes dos comandos registrados vivem até o fim do programa, podem ir para o log adiado
+    DLOGI(__FUNCTION__, "Comando %u encontrado: %s, %u bytes de dados", commandCode,
+          command.InternalName.c_str(), static_cast<unsigned>(rxData.size()));
+
+    uint8_t index;
+    if (!AcquireEnvelope(connection, command, index)) return CommonErrorCodes::Busy;
+
+    auto &envelope = envelopes[index];
+    ErrorCode error = CommonErrorCodes::None;
+    if (batch && !binary) {
+        bool read = lengthPrefixed ? ReadBatchLengthPrefixed(rxData, envelope.Args)
+                                   : ReadBatchLines(rxData, envelope.Args);
+        error = read ? CommonErrorCodes::None : CommonErrorCodes::ArgumentError;
+    } else {
+        Tokenizer tokenizer(binary ? std::string_view() : rxData, ':');
+        error = ReadArgs(command, binary, frame, tokenizer, envelope.Args);
     }
-}
\ No newline at end of file
+    if (error == CommonErrorCodes::None && batch && envelope.Args.empty()) {
+        error = CommonErrorCodes::ArgumentError;
+    }
+    if (error != CommonErrorCodes::None) {
+        ReleaseEnvelope(index);
+        return error;
+    }
+    return Enqueue(index, command, connection, binary ? frame.requestId() : 0, flags, binary);
+}
+
+ErrorCode Commander::CheckForNamedCommand(std::string_view name, std::string_view arguments,
+                                          BaseConnection *connection) {
+    TraceSpan span("Commander::CheckForNamedCommand", "command");
+    const DeviceCommand *found = FindCommand(name);
+    if (found == nullptr) {
+        ESP_LOGW(__FUNCTION__, "Comando %.*s desconhecido", static_cast<int>(name.size()), name.data());
+        return CommonErrorCodes::InvalidCommand;
+    }
+
+    uint8_t index;
+    if (!AcquireEnvelope(connection, *found, index)) return CommonErrorCodes::Busy;
+    CommandFrame frame;
+    Tokenizer tokenizer(arguments, ' ', TokenizerMode::Words);
+    ErrorCode error = ReadArgs(*found, false, frame, tokenizer, envelopes[index].Args);
+    if (error != CommonErrorCodes::None) {
+        ReleaseEnvelope(index);
+        return error;
+    }
+    return Enqueue(index, *found, connection, 0, CommandFrameFlagNone, false);
+}
+
+ErrorCode Commander::Enqueue(uint8_t index, const DeviceCommand &command, BaseConnection *connection,
+                             uint16_t requestId, uint8_t flags, bool binary) {
+    auto &envelope = envelopes[index];
+    bool batch = &command == &BatchCommand;
+    // O lote vai para a tarefa lenta se algum comando for lento e gasta as fichas de todos
+    bool slow = (command.Flags & CommandFlagSlow) != 0;
+    uint32_t cost = batch ? 0 : _limits[command.Code].Cost;
+    for (size_t i = 0; batch && i < envelope.Args.size(); i++) {
+        // O código é o primeiro byte nos dois formatos do lote
+        auto packet = envelope.Args[i];
+        const DeviceCommand *item = packet.empty() ? nullptr : _table[static_cast<uint8_t>(packet[0])];
+        if (item == nullptr) continue;
+        slow = slow || (item->Flags & CommandFlagSlow);
+        cost += _limits[item->Code].Cost;
+    }
+    // Um lote maior que o balde passaria nunca: gasta no máximo o balde cheio
+    if (cost > rateBurst) cost = rateBurst;
+    ConnectionHandle handle = ConnectionManager::getHandle(connection);
+    if (handle.valid() && ConnectionManager::getConnection(handle) == nullptr) {
+        // Chegou depois da desconexão; a conexão do pool não tem a quem responder
+        ReleaseEnvelope(index);
+        return CommonErrorCodes::ConnectionClosed;
+    }
+    int lane = AcquireLane(connection, handle, command.Code, slow, _limits[command.Code].MaxInFlight, cost);
+    if (lane < 0) {
+        ReleaseEnvelope(index);
+        RejectBusy(connection, command, lane == LaneThrottled,
+                   lane == LaneThrottled ? "taxa da conexao excedida" : "fila da conexao cheia");
+        return CommonErrorCodes::Busy;
+    }
+
+    envelope.Command = &command;
+    envelope.Connection = connection;
+    envelope.Handle = handle;
+    envelope.RequestId = requestId;
+    envelope.Flags = flags;
+    envelope.Binary = binary;
+    envelope.FlowId = Trace::newFlowId();
+    Trace::flowStart("command", envelope.FlowId);
+    envelope.Received = Metrics::now();
+    xQueueSendToBack(xLaneQueues[lane], &index, 0);
+    static Gauge &queueDepth = Metrics::gauge("command.queue_depth");
+    queueDepth.set(static_cast<int32_t>(COMMAND_POOL_SIZE - uxQueueMessagesWaiting(xFreeEnvelopes)));
+    return CommonErrorCodes::None;
+}
@@ -5,40 +5,324 @@
 #ifndef COMMANDER_H
 #define COMMANDER_H
 
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <list>
 #include <vector>
+#include <Convert.h>
+#include "CommandFrame.h"
 #include "BaseConnection.h"
 
+#ifndef COMMAND_POOL_SIZE
+/**
+ * Envelopes de comando pré-alocados (na fila ou em execução). Sem envelope livre o comando é recusado com Busy.
+ */
+#define COMMAND_POOL_SIZE 10
+#endif
+
+#ifndef COMMAND_ARGS_CAPACITY
+/**
+ * Bytes disponíveis para os argumentos decodificados de um comando.
+ */
+#define COMMAND_ARGS_CAPACITY 512
+#endif
+
+#ifndef COMMAND_MAX_ARGS
+#define COMMAND_MAX_ARGS 16
+#endif
+
+#ifndef COMMAND_WORKERS
+/**
+ * Tarefas executando comandos rápidos, alternando os núcleos. Comandos com CommandFlagSlow têm uma tarefa à parte.
+ */
+#define COMMAND_WORKERS 2
+#endif
+
+#ifndef COMMAND_MAX_PENDING_PER_CONNECTION
+/**
+ * Comandos de uma mesma conexão na fila ou em execução. Acima disso o comando é recusado com Busy.
+ */
+#define COMMAND_MAX_PENDING_PER_CONNECTION 4
+#endif
+
+#ifndef COMMAND_RATE_PER_SECOND
+/**
+ * Fichas por segundo do balde de cada conexão; cada comando gasta CommandLimit::Cost. 0 desliga o limite.
+ */
+#define COMMAND_RATE_PER_SECOND 20
+#endif
+
+#ifndef COMMAND_RATE_BURST
+/**
+ * Capacidade do balde: quantas fichas uma conexão ociosa acumula para uma rajada.
+ */
+#define COMMAND_RATE_BURST 10
+#endif
+
+#ifndef COMMAND_WORKER_STACK
+#define COMMAND_WORKER_STACK 8192
+#endif
+
+/**
+ * Códigos de comando possíveis: o código é o primeiro byte do pacote.
+ */
+#define COMMAND_CODE_COUNT (UINT8_MAX + 1)
+
+/**
+ * Flags de DeviceCommand::Flags, combináveis com |.
+ */
+enum CommandFlags : uint8_t {
+    CommandFlagNone = 0,
+    CommandFlagAnyArgs = 1 << 0, /**< Não confere o número de argumentos com DataSize */
+    CommandFlagSlow = 1 << 1,    /**< Pode demorar (armazenamento, OTA): executa na tarefa lenta */
+};
+
 class BaseConnection;
 
+/**
+ * Argumentos de um comando recebido, guardados no próprio envelope do pool.
+ * As views só são válidas enquanto o handler executa. No quadro binário os valores são copiados
+ * uma vez, sem decodificar, e podem conter qualquer byte.
+ */
+class CommandArgs {
+public:
+    size_t size() const {
+        return _count;
+    }
+
+    bool empty() const {
+        return _count == 0;
+    }
+
+    std::string_view operator[](size_t index) const {
+        if (index >= _count) return {};
+        return {_data + _offsets[index], static_cast<size_t>(_offsets[index + 1] - _offsets[index])};
+    }
+
+    /**
+     * Tipo do argumento no quadro binário (definido pela aplicação); 0 no texto.
+     */
+    uint8_t type(size_t index) const {
+        return index < _count ? _types[index] : 0;
+    }
+
+    /**
+     * Copia o valor binário (little-endian) do argumento. Retorna false se faltar ou o tamanho não for sizeof(T).
+     */
+    template<typename T>
+    bool read(size_t index, T &value) const {
+        static_assert(std::is_trivially_copyable_v<T>, "CommandArgs::read needs a trivially copyable type");
+        auto raw = (*this)[index];
+        if (index >= _count || raw.size() != sizeof(T)) return false;
+        memcpy(&value, raw.data(), sizeof(T));
+        return true;
+    }
+
+    /**
+     * Converte o argumento com Convert::fromString. Retorna false se faltar ou for inválido.
+     */
+    template<typename T>
+    bool get(size_t index, T &value) const {
+        return index < _count && Convert::fromString((*this)[index], value) == std::errc();
+    }
+
+    /**
+     * Cópia no formato antigo, para handlers que recebem std::vector<std::string>.
+     */
+    std::vector<std::string> toVector() const {
+        std::vector<std::string> result;
+        result.reserve(_count);
+        for (size_t i = 0; i < _count; i++) {
+            result.emplace_back((*this)[i]);
+        }
+        return result;
+    }
+
+    /**
+     * Decodifica um token do Tokenizer para o buffer. Retorna false se não couber.
+     */
+    bool append(std::string_view token);
+
+    /**
+     * Copia um valor do quadro binário como está. Retorna false se não couber.
+     */
+    bool append(std::string_view value, uint8_t type);
+
+    void clear() {
+        _count = 0;
+        _offsets[0] = 0;
+    }
+
+private:
+    char _data[COMMAND_ARGS_CAPACITY]{};
+    uint16_t _offsets[COMMAND_MAX_ARGS + 1]{};
+    uint8_t _types[COMMAND_MAX_ARGS]{};
+    uint8_t _count = 0;
+};
+
+/**
+ * Comando definido em tempo de compilação. Uma tabela constexpr destes é registrada com
+ * Commander::AddCommands, e Commander::HasUniqueCodes permite recusar códigos repetidos num static_assert.
+ */
+struct CommandSpec {
+    uint8_t Code;
+    uint8_t DataSize;
+    const char *InternalName;
+    void (*Function)(const CommandArgs &, BaseConnection *);
+    uint8_t Flags = CommandFlagNone;
+};
+
+/**
+ * Limites de admissão de um código de comando, por conexão. Ver Commander::SetLimit.
+ */
+struct CommandLimit {
+    uint8_t Cost = 1;        /**< Fichas gastas a cada comando; 0 não passa pelo limite de taxa */
+    uint8_t MaxInFlight = 0; /**< Comandos com o código pendentes por conexão; 0 fica só com o limite geral */
+};
+
 class DeviceCommand {
 public:
     DeviceCommand(const uint32_t dataSize, std::string internalName, const uint8_t code,
                   std::function<void(const std::vector<std::string> &,
-                                     BaseConnection *)> functionPtr) : DataSize(
-            dataSize), InternalName(std::move(internalName)), Code(code), Function(
+                                     BaseConnection *)> functionPtr, const uint8_t flags = CommandFlagNone) : DataSize(
+            dataSize), InternalName(std::move(internalName)), Code(code), Flags(flags), Function(
             std::move(functionPtr)) {}
 
+    /**
+     * Handler que lê os argumentos direto do envelope, sem criar strings.
+     */
+    DeviceCommand(const uint32_t dataSize, std::string internalName, const uint8_t code,
+                  std::function<void(const CommandArgs &, BaseConnection *)> argsFunction,
+                  const uint8_t flags = CommandFlagNone) : DataSize(
+            dataSize), InternalName(std::move(internalName)), Code(code), Flags(flags), ArgsFunction(
+            std::move(argsFunction)) {}
+
+    explicit DeviceCommand(const CommandSpec &spec) : DeviceCommand(spec.DataSize, spec.InternalName, spec.Code,
+                                                                    spec.Function, spec.Flags) {}
+
     const uint32_t DataSize;
     std::string InternalName;
     const uint8_t Code;
+    const uint8_t Flags;
     std::function<void(const std::vector<std::string> &, BaseConnection *)> Function;
+    std::function<void(const CommandArgs &, BaseConnection *)> ArgsFunction;
 };
 
 class Commander {
 public:
     Commander() = delete;
 
-    static void CheckForCommand(const std::string &rxValue, BaseConnection *connection);
+    /**
+     * Coloca o comando na fila de execução. Comandos da mesma conexão executam na ordem de chegada;
+     * conexões diferentes executam em paralelo. Nunca bloqueia.
+     * O pacote é lido no enquadramento da conexão (texto ou CommandFrame); COMMAND_FRAMING_CODE troca o
+     * enquadramento na hora, sem passar pela fila.
+     * No quadro binário o id do pedido vai como "RequestId" em cada resposta JSON enviada pelo handler durante a
+     * execução, então o cliente pode mandar vários pedidos sem esperar as respostas.
+     * COMMAND_BATCH_CODE traz um lote (até COMMAND_MAX_ARGS comandos) que ocupa um envelope só, executa em ordem
+     * numa mesma tarefa e é respondido com um único BatchResultJson.
+     * Cada conexão tem um balde de fichas (COMMAND_RATE_PER_SECOND, COMMAND_RATE_BURST) do qual cada comando
+     * gasta o custo do seu código; um lote gasta a soma dos seus comandos.
+     * @return Busy (já respondido à conexão) se não houver envelope livre, a conexão tiver
+     * COMMAND_MAX_PENDING_PER_CONNECTION comandos pendentes (ou CommandLimit::MaxInFlight do código) ou
+     * faltarem fichas no balde, InvalidCommand/ArgumentError se o comando for inválido, ConnectionClosed se a
+     * conexão é do pool e já foi desconectada. O envelope guarda o ConnectionHandle do cliente: se ele sair antes
+     * da execução, o comando é descartado em vez de responder ao próximo cliente da mesma conexão.
+     */
+    static ErrorCode CheckForCommand(const std::string &rxValue, BaseConnection *connection);
+
+    /**
+     * Coloca na fila o comando com o nome (sem diferenciar maiúsculas), com os argumentos separados por espaços
+     * (aspas agrupam, '\' escapa). Mesmos envelopes, tarefas e limites de CheckForCommand; usado pelo Telnet.
+     * @return Os mesmos erros de CheckForCommand.
+     */
+    static ErrorCode CheckForNamedCommand(std::string_view name, std::string_view arguments,
+                                          BaseConnection *connection);
 
+    /**
+     * Registra o comando. Um código já usado, COMMAND_FRAMING_CODE ou COMMAND_BATCH_CODE é recusado com erro no log.
+     */
     static void AddCommand(const DeviceCommand &command);
 
+    template<size_t N>
+    static void AddCommands(const CommandSpec (&specs)[N]) {
+        for (const auto &spec: specs) {
+            AddCommand(DeviceCommand(spec));
+        }
+    }
+
+    /**
+     * Confere em tempo de compilação que uma tabela de comandos não repete códigos:
+     * static_assert(Commander::HasUniqueCodes(comandos), "Códigos de comando repetidos");
+     */
+    template<size_t N>
+    static constexpr bool HasUniqueCodes(const CommandSpec (&specs)[N]) {
+        for (size_t i = 0; i < N; i++) {
+            for (size_t j = i + 1; j < N; j++) {
+                if (specs[i].Code == specs[j].Code) return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Comando registrado com o código, ou nullptr. Uma leitura indexada.
+     */
+    static const DeviceCommand *FindCommand(uint8_t code);
+
+    /**
+     * Comando registrado com o nome, sem diferenciar maiúsculas, ou nullptr. Percorre a lista.
+     */
+    static const DeviceCommand *FindCommand(std::string_view name);
+
+    /**
+     * Comandos registrados, na ordem de registro.
+     */
+    static const std::list<DeviceCommand> &GetCommands();
+
     static void Init();
 
+    /**
+     * Define os limites do código. O custo deve caber no balde (COMMAND_RATE_BURST), senão o comando nunca passa.
+     * Chamar na inicialização, junto com AddCommand.
+     */
+    static void SetLimit(uint8_t code, CommandLimit limit);
+
+    /**
+     * Troca a taxa e a capacidade do balde de todas as conexões. 0 fichas por segundo desliga o limite.
+     */
+    static void SetRate(uint16_t perSecond, uint16_t burst);
+
+    /**
+     * Comandos recusados com Busy, pelos dois motivos abaixo.
+     */
+    static uint32_t GetRejectedCount();
+
+    /**
+     * Comandos recusados por falta de fichas no balde da conexão.
+     */
+    static uint32_t GetThrottledCount();
+
+    /**
+     * Comandos recusados por falta de envelope ou por limite de comandos pendentes.
+     */
+    static uint32_t GetDroppedCount();
+
 private:
+    /**
+     * Admite o comando cujos argumentos já estão no envelope e o coloca na fila. Recusado, libera o envelope.
+     */
+    static ErrorCode Enqueue(uint8_t index, const DeviceCommand &command, BaseConnection *connection,
+                             uint16_t requestId, uint8_t flags, bool binary);
+
     static std::list<DeviceCommand> _commands;
+    static std::array<const DeviceCommand *, COMMAND_CODE_COUNT> _table;
+    static std::array<CommandLimit, COMMAND_CODE_COUNT> _limits;
 
 };
 
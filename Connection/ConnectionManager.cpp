@@ -3,39 +3,93 @@
 //
 
 #include <esp_log.h>
+#include <esp_heap_caps.h>
+#include "freertos/FreeRTOS.h"
+#include <Metrics.h>
 #include "ConnectionManager.h"
 #include "BaseConnection.h"
+#include "NotificationHub.h"
 
 // ConnectedUser.h está no componente UserManaging, não é necessário aqui
 
 //#define DEBUG_INFO
 
-SafeList<BaseConnection*> ConnectionManager::_connectionPool;
+// Campos de ConnectionSlot::state
+static constexpr uint32_t IdMask = 0xFFFF;
+static constexpr uint32_t ConnectedBit = 1u << 16;
+static constexpr uint32_t GenerationShift = 17;
+static constexpr uint32_t GenerationMask = UINT32_MAX >> GenerationShift;
+
+static constexpr uint16_t GenerationOf(uint32_t state) {
+    return static_cast<uint16_t>(state >> GenerationShift);
+}
+
+static constexpr bool IsConnectedAs(uint32_t state, uint16_t id) {
+    return (state & ConnectedBit) != 0 && (state & IdMask) == id;
+}
+
+// Protege as escritas (slots, lista livre e índice); as leituras não travam
+static portMUX_TYPE connectionMux = portMUX_INITIALIZER_UNLOCKED;//NOLINT
+
+std::array<ConnectionManager::ConnectionSlot, CONNECTION_MAX_CONNECTIONS> ConnectionManager::_slots;//NOLINT
+std::array<std::atomic<uint8_t>, ConnectionManager::IndexSize> ConnectionManager::_index{};//NOLINT
+std::atomic<uint8_t> ConnectionManager::_slotCount{0};//NOLINT
+std::atomic<uint8_t> ConnectionManager::_freeHead{ConnectionManager::NoSlot};//NOLINT
 Event<ConnectionManager*, BaseConnection*> ConnectionManager::onConnect;
 
-ErrorCode ConnectionManager::initialize(size_t numConnections) {
-    // ConnectionManager genérico não cria conexões automaticamente
-    // As conexões devem ser adicionadas via addConnection()
-    // Este método apenas inicializa o pool vazio
+ErrorCode ConnectionManager::initialize(size_t numConnections, ConnectionFactory create) {
+    size_t freeSlots = CONNECTION_MAX_CONNECTIONS - _slotCount.load(std::memory_order_acquire);
+    if (create == nullptr || numConnections > freeSlots) {
+        ESP_LOGE(__FUNCTION__, "%d conexões não cabem na tabela (%d)", static_cast<int>(numConnections),
+                 CONNECTION_MAX_CONNECTIONS);
+        return CommonErrorCodes::ArgumentError;
+    }
+
+    // Tudo o que uma conexão usa é alocado aqui; depois disso conectar e desconectar não usam o heap
+    size_t freeHeap = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    for (size_t i = 0; i < numConnections; i++) {
+        auto *connection = create();
+        if (connection == nullptr) {
+            ESP_LOGE(__FUNCTION__, "Falha ao criar a conexão %d de %d", static_cast<int>(i + 1),
+                     static_cast<int>(numConnections));
+            return CommonErrorCodes::OperationFailed;
+        }
+        addConnection(connection);
+    }
+
+    ESP_LOGI(__FUNCTION__, "%d conexões pré-alocadas, %d bytes", static_cast<int>(numConnections),
+             static_cast<int>(freeHeap - heap_caps_get_free_size(MALLOC_CAP_DEFAULT)));
     return CommonErrorCodes::None;
 }
 
 void ConnectionManager::addConnection(BaseConnection* connection) {
-    if (connection != nullptr) {
-        _connectionPool.Push(connection);
+    if (connection == nullptr) return;
+
+    portENTER_CRITICAL(&connectionMux);
+    uint8_t slot = _slotCount.load(std::memory_order_relaxed);
+    if (slot < CONNECTION_MAX_CONNECTIONS) {
+        _slots[slot].connection.store(connection, std::memory_order_release);
+        _slots[slot].nextFree = _freeHead.load(std::memory_order_relaxed);
+        _freeHead.store(slot, std::memory_order_release);
+        _slotCount.store(slot + 1, std::memory_order_release);
     }
-}
+    portEXIT_CRITICAL(&connectionMux);
 
-BaseConnection* ConnectionManager::getFreeConnection() {
-    if (_connectionPool.IsLocked()) {
-        ESP_LOGE(__FUNCTION__, "Falha tentando obter semaforo");
-        return nullptr;
+    if (slot >= CONNECTION_MAX_CONNECTIONS) {
+        ESP_LOGE(__FUNCTION__, "Tabela de conexões cheia (%d)", CONNECTION_MAX_CONNECTIONS);
+        return;
     }
 
-    for (auto* conn : _connectionPool) {
-        if (conn != nullptr && !conn->isConnected()) {
-            return conn;
-        }
+    // O slot é da conexão para sempre: quando ela se desconecta, por onde for, o slot volta para a lista livre
+    connection->onDisconnect.addHandler([slot](BaseConnection *, void *) {
+        release(slot, _slots[slot].state.load(std::memory_order_acquire));
+    }).release();
+}
+
+BaseConnection* ConnectionManager::getFreeConnection() {
+    uint8_t slot = _freeHead.load(std::memory_order_acquire);
+    if (slot != NoSlot) {
+        return _slots[slot].connection.load(std::memory_order_acquire);
     }
 
     ESP_LOGE(__FUNCTION__, "Sem Conexões livres");
@@ -43,21 +97,47 @@ BaseConnection* ConnectionManager::getFreeConnection() {
 }
 
 ErrorCode ConnectionManager::connect(uint16_t id) {
-    auto* connection = getFreeConnection();
-    if (connection != nullptr) {
-        // A conexão específica deve implementar o método connect(id)
-        // Por enquanto, apenas notificamos que uma conexão foi associada
-        onConnect.trigger(nullptr, connection);
-        return CommonErrorCodes::None;
-    } else {
+    BaseConnection *connection = nullptr;
+    bool duplicated;
+
+    portENTER_CRITICAL(&connectionMux);
+    duplicated = findSlot(id) != NoSlot;
+    uint8_t slot = _freeHead.load(std::memory_order_relaxed);
+    if (!duplicated && slot != NoSlot) {
+        auto &entry = _slots[slot];
+        _freeHead.store(entry.nextFree, std::memory_order_release);
+        uint32_t generation = entry.state.load(std::memory_order_relaxed) & ~(ConnectedBit | IdMask);
+        entry.state.store(generation | ConnectedBit | id, std::memory_order_release);
+
+        // O estado é publicado antes da entrada do índice, então quem acha a entrada já lê o ID certo
+        size_t position = id & (IndexSize - 1);
+        for (uint8_t value = _index[position].load(std::memory_order_relaxed); value != 0 && value != NoSlot;
+             value = _index[position].load(std::memory_order_relaxed)) {
+            position = (position + 1) & (IndexSize - 1);
+        }
+        _index[position].store(slot + 1, std::memory_order_release);
+        connection = entry.connection.load(std::memory_order_relaxed);
+    }
+    portEXIT_CRITICAL(&connectionMux);
+
+    if (duplicated) {
+        ESP_LOGE(__FUNCTION__, "Id %d já conectado", id);
+        return CommonErrorCodes::ArgumentError;
+    }
+    if (connection == nullptr) {
         ESP_LOGE(__FUNCTION__, "Sem conexões livres");
         return CommonErrorCodes::OperationFailed;
     }
+
+    onConnect.trigger(nullptr, connection);
+    return CommonErrorCodes::None;
 }
 
 void ConnectionManager::disconnect(uint16_t id) {
-    auto* conn = getConnectionById(id);
-    if (conn == nullptr) return;
+    uint8_t slot = findSlot(id);
+    if (slot == NoSlot) return;
+    uint32_t state = _slots[slot].state.load(std::memory_order_acquire);
+    if (!IsConnectedAs(state, id)) return;
 
 #ifdef USER_MANAGEMENT_ENABLED
 #ifdef DEBUG_INFO
@@ -65,69 +145,128 @@ void ConnectionManager::disconnect(uint16_t id) {
 #endif
 #endif
 
-    conn->disconnect();
+    _slots[slot].connection.load(std::memory_order_acquire)->disconnect();
+    // Normalmente o onDisconnect já liberou; se a conexão já estava desconectada, libera aqui
+    release(slot, state);
 }
 
 BaseConnection* ConnectionManager::getConnectionById(uint16_t id) {
-    if (_connectionPool.IsLocked()) {
-        ESP_LOGE(__FUNCTION__, "Falha tentando obter semaforo");
-        return nullptr;
-    }
-
-    for (auto* connection : _connectionPool) {
-        if (connection != nullptr && connection->isConnected()) {
-            // BaseConnection não tem GetId() diretamente
-            // Implementações específicas devem fornecer uma forma de identificar conexões
-            // Por enquanto, retornamos a primeira conexão conectada
-            // TODO: Adicionar método getId() ao BaseConnection ou usar um mapa de IDs
-            return connection;
-        }
+    uint8_t slot = findSlot(id);
+    if (slot != NoSlot) {
+        return _slots[slot].connection.load(std::memory_order_acquire);
     }
 
     ESP_LOGE(__FUNCTION__, "Conexão com Id %d nao encontrado", id);
     return nullptr;
 }
 
-void ConnectionManager::sendNotifications() {
-    if (_connectionPool.Empty()) {
-        return;
-    }
+ConnectionHandle ConnectionManager::getHandle(uint16_t id) {
+    uint8_t slot = findSlot(id);
+    if (slot == NoSlot) return {};
+    uint32_t state = _slots[slot].state.load(std::memory_order_acquire);
+    if (!IsConnectedAs(state, id)) return {};
+    return {slot, GenerationOf(state)};
+}
 
-    if (_connectionPool.IsLocked()) {
-        ESP_LOGE(__FUNCTION__, "Falha tentando obter semaforo");
-        return;
+ConnectionHandle ConnectionManager::getHandle(const BaseConnection* connection) {
+    uint8_t count = _slotCount.load(std::memory_order_acquire);
+    for (uint8_t slot = 0; slot < count; slot++) {
+        if (_slots[slot].connection.load(std::memory_order_acquire) != connection) continue;
+        uint32_t state = _slots[slot].state.load(std::memory_order_acquire);
+        // Desconectada, a geração atual é a do próximo cliente; a do último já foi encerrada
+        uint16_t generation = GenerationOf(state);
+        if ((state & ConnectedBit) == 0) generation = (generation - 1) & GenerationMask;
+        return {slot, generation};
     }
+    return {};
+}
 
-    for (auto* connection : _connectionPool) {
-        if (connection == nullptr || !connection->isConnected()) {
-            continue;
-        }
-
-#ifdef USER_MANAGEMENT_ENABLED
-        // TODO: Implementar suporte a UserManagement quando necessário
-        // Por enquanto, apenas enviamos notificações normais
-#endif
+BaseConnection* ConnectionManager::getConnection(ConnectionHandle handle) {
+    if (handle.slot >= _slotCount.load(std::memory_order_acquire)) return nullptr;
+    uint32_t state = _slots[handle.slot].state.load(std::memory_order_acquire);
+    if ((state & ConnectedBit) == 0 || GenerationOf(state) != handle.generation) return nullptr;
+    return _slots[handle.slot].connection.load(std::memory_order_acquire);
+}
 
-        // BaseConnection não tem GetNotificationNeeds() diretamente
-        // Por enquanto, enviamos notificações para todas as conexões conectadas
-        // TODO: Adicionar suporte a NotificationNeeds ao BaseConnection
+uint8_t ConnectionManager::findSlot(uint16_t id) {
+    // Sondagem linear a partir do ID; entradas removidas são puladas, uma vazia termina a busca
+    size_t position = id & (IndexSize - 1);
+    for (size_t probe = 0; probe < IndexSize; probe++, position = (position + 1) & (IndexSize - 1)) {
+        uint8_t value = _index[position].load(std::memory_order_acquire);
+        if (value == 0) break;
+        if (value == NoSlot) continue;
+        if (IsConnectedAs(_slots[value - 1].state.load(std::memory_order_acquire), id)) return value - 1;
     }
+    return NoSlot;
 }
 
-void ConnectionManager::notifyAll(NotificationNeeds needs) {
-    if (_connectionPool.Empty()) {
-        return;
+void ConnectionManager::release(uint8_t slot, uint32_t state) {
+    if ((state & ConnectedBit) == 0) return;
+    uint16_t id = state & IdMask;
+
+    auto &entry = _slots[slot];
+    BaseConnection *recycled = nullptr;
+    bool indexed = true;
+    portENTER_CRITICAL(&connectionMux);
+    // Outra liberação (ou outra conexão no mesmo slot) chegou antes
+    if (entry.state.load(std::memory_order_relaxed) == state) {
+        size_t position = id & (IndexSize - 1);
+        size_t probe = 0;
+        while (probe < IndexSize && _index[position].load(std::memory_order_relaxed) != slot + 1) {
+            position = (position + 1) & (IndexSize - 1);
+            probe++;
+        }
+        indexed = probe < IndexSize;
+        if (indexed) {
+            _index[position].store(NoSlot, std::memory_order_release);
+            // No fim da cadeia as entradas removidas podem voltar a vazias sem cortar a busca de ninguém
+            if (_index[(position + 1) & (IndexSize - 1)].load(std::memory_order_relaxed) == 0) {
+                while (_index[position].load(std::memory_order_relaxed) == NoSlot) {
+                    _index[position].store(0, std::memory_order_release);
+                    position = (position + IndexSize - 1) & (IndexSize - 1);
+                }
+            }
+
+            uint32_t generation = (GenerationOf(state) + 1u) << GenerationShift;
+            entry.state.store(generation, std::memory_order_release);
+            recycled = entry.connection.load(std::memory_order_relaxed);
+        }
     }
+    portEXIT_CRITICAL(&connectionMux);
 
-    if (_connectionPool.IsLocked()) {
-        ESP_LOGE(__FUNCTION__, "Falha tentando obter semaforo");
+    if (!indexed) {
+        ESP_LOGE(__FUNCTION__, "Slot %d (id %d) não está no índice, liberação ignorada", slot, id);
         return;
     }
+    if (recycled == nullptr) return;
+
+    // Código da conexão fica fora da seção crítica. O slot já saiu do índice e só volta para a lista depois de
+    // limpo, para o próximo cliente não herdar o estado deste
+    recycled->recycle();
+    portENTER_CRITICAL(&connectionMux);
+    entry.nextFree = _freeHead.load(std::memory_order_relaxed);
+    _freeHead.store(slot, std::memory_order_release);
+    portEXIT_CRITICAL(&connectionMux);
+}
 
-    for (auto* connection : _connectionPool) {
-        if (connection != nullptr) {
-            // BaseConnection não tem SetNotificationNeeds() diretamente
-            // TODO: Adicionar suporte a NotificationNeeds ao BaseConnection
+void ConnectionManager::sendNotifications() {
+    static Histogram &roundTime = Metrics::histogram("notify.round_us");
+    HistogramTimer timer(roundTime);
+
+    // Cada tópico que mudou é serializado uma vez só, antes de percorrer as conexões
+    uint32_t changed = NotificationHub::prepare();
+    uint8_t count = _slotCount.load(std::memory_order_acquire);
+    for (uint8_t slot = 0; slot < count; slot++) {
+        if ((_slots[slot].state.load(std::memory_order_acquire) & ConnectedBit) == 0) {
+            continue;
         }
+        NotificationHub::deliver(_slots[slot].connection.load(std::memory_order_acquire), changed);
+    }
+}
+
+void ConnectionManager::notifyAll(NotificationNeeds needs) {
+    uint8_t count = _slotCount.load(std::memory_order_acquire);
+    for (uint8_t slot = 0; slot < count; slot++) {
+        _slots[slot].connection.load(std::memory_order_acquire)->setNotificationNeeds(needs);
     }
 }
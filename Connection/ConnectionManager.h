@@ -1,8 +1,9 @@
 #ifndef CONNECTIONMANAGER_H
 #define CONNECTIONMANAGER_H
 
-#include <list>
-#include "SafeList.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include "BaseConnection.h" // Now includes BaseConnection
 #include "Event.h"
 #include "CommonErrorCodes.h"
@@ -12,70 +13,149 @@
  * @brief Defines the ConnectionManager class for managing multiple communication connections.
  */
 
+#ifndef CONNECTION_MAX_CONNECTIONS
+/**
+ * @brief Slots in the connection table. Connections added after it is full are refused.
+ */
+#define CONNECTION_MAX_CONNECTIONS 8
+#endif
+
+static_assert(CONNECTION_MAX_CONNECTIONS > 0 && CONNECTION_MAX_CONNECTIONS < UINT8_MAX,
+              "CONNECTION_MAX_CONNECTIONS must fit a slot index");
+
+/**
+ * @struct ConnectionHandle
+ * @brief Reference to one connection lease (a slot and its generation).
+ *
+ * The generation changes every time the slot is released, so a handle kept after a disconnect resolves to
+ * nullptr instead of to whoever connected on the same slot later.
+ */
+struct ConnectionHandle {
+    uint8_t slot = UINT8_MAX;
+    uint16_t generation = 0;
+
+    [[nodiscard]] bool valid() const {
+        return slot != UINT8_MAX;
+    }
+
+    bool operator==(const ConnectionHandle& other) const {
+        return slot == other.slot && generation == other.generation;
+    }
+
+    bool operator!=(const ConnectionHandle& other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * @brief Creates one connection of the pool, with everything it needs to serve a client. Returns nullptr on failure.
+ */
+using ConnectionFactory = BaseConnection *(*)();
+
 /**
  * @class ConnectionManager
  * @brief Manages a pool of BaseConnection objects, handling connection, disconnection, and notifications.
+ *
+ * Connections live in a fixed table of CONNECTION_MAX_CONNECTIONS slots. The free slots form a list, so taking
+ * one is O(1), and the connected ones are indexed by ID in an open-addressed table. Lookups (by ID or by handle)
+ * only read atomics and never lock; connecting and disconnecting take a short critical section.
  */
 class ConnectionManager {
 public:
     /**
      * @brief Initializes the ConnectionManager with a specified number of connections.
-     * 
-     * This method should be called once at the start of the application.
-     * 
+     *
+     * This method should be called once at the start of the application. The connections are created here, with
+     * all their buffers, and are never freed: a disconnected connection is recycled and goes back to the free list,
+     * so connecting allocates nothing and the heap used by the pool is known (and logged) at boot.
+     *
      * @param numConnections The initial number of connections to create in the pool.
-     * @return ErrorCode indicating success or failure of the initialization.
+     * @param create Creates each connection.
+     * @return ErrorCode indicating success or failure of the initialization. CommonErrorCodes::ArgumentError if the
+     *         connections do not fit the free slots, CommonErrorCodes::OperationFailed if create fails (the
+     *         connections already created stay in the pool).
      */
-    static ErrorCode initialize(size_t numConnections);
+    static ErrorCode initialize(size_t numConnections, ConnectionFactory create);
 
     /**
      * @brief Adds a new BaseConnection to the connection pool.
      *
+     * The connection takes a slot for good and goes to the free list. Its onDisconnect recycles it and releases
+     * the slot.
+     *
      * @param connection A pointer to the BaseConnection object to add.
      */
     static void addConnection(BaseConnection* connection);
 
     /**
-     * @brief Gets a free (unused) connection from the pool.
+     * @brief Gets a free (unused) connection from the pool. O(1): the head of the free list.
      *
-     * @return A pointer to a free BaseConnection, or nullptr if no free connections are available. 
+     * @return A pointer to a free BaseConnection, or nullptr if no free connections are available.
      */
     static BaseConnection* getFreeConnection();
 
     /**
      * @brief Connects a connection from the pool to a specific ID.
      *
-     * This method searches for a free connection and associates it with the provided ID.
+     * This method takes the first free connection and associates it with the provided ID.
      *
-     * @param id The ID to connect to.
-     * @return ErrorCode indicating success or failure. CommonErrorCodes::NoFreeConnections is returned 
-     *         if no free connections are available.
+     * @param id The ID to connect to (a BLE connection handle, a socket).
+     * @return ErrorCode indicating success or failure. CommonErrorCodes::OperationFailed is returned
+     *         if no free connections are available, CommonErrorCodes::ArgumentError if the ID is already connected.
      */
     static ErrorCode connect(uint16_t id);
 
     /**
-     * @brief Disconnects a connection with the specified ID.
+     * @brief Disconnects a connection with the specified ID and releases its slot.
      *
      * @param id The ID of the connection to disconnect.
      */
     static void disconnect(uint16_t id);
 
     /**
-     * @brief Gets a connection from the pool by its ID.
+     * @brief Gets a connection from the pool by its ID. Lock-free.
      *
      * @param id The ID of the connection to retrieve.
      * @return A pointer to the BaseConnection with the matching ID, or nullptr if not found.
      */
     static BaseConnection* getConnectionById(uint16_t id);
 
+    /**
+     * @brief Gets a handle to the connection currently associated with the ID. Lock-free.
+     *
+     * @return The handle, not valid() if the ID is not connected.
+     */
+    static ConnectionHandle getHandle(uint16_t id);
+
+    /**
+     * @brief Gets a handle to the client the connection is serving now. Lock-free, O(slots).
+     *
+     * Lets code that only got the connection pointer (a received command) hold on to the client instead of to
+     * the object, which is recycled for the next client.
+     *
+     * @return The handle, not valid() if the connection is not in the pool. A pooled connection that is not
+     *         connected gets the handle of its last client, which no longer resolves.
+     */
+    static ConnectionHandle getHandle(const BaseConnection* connection);
+
+    /**
+     * @brief Resolves a handle. Lock-free.
+     *
+     * @return The connection, or nullptr if it disconnected since the handle was taken.
+     */
+    static BaseConnection* getConnection(ConnectionHandle handle);
+
     /**
      * @brief Sends notifications to all connected clients based on their notification needs.
+     *
+     * Runs one NotificationHub round: the topics that changed are serialized once and sent to every connected
+     * client subscribed to them. Call it periodically from a single task.
      */
     static void sendNotifications();
 
     /**
      * @brief Sets the notification needs for all connections to the specified level.
-     * 
+     *
      * This is used to force all connections to send a notification, regardless of their previous state.
      *
      * @param needs The notification level to set for all connections.
@@ -84,17 +164,45 @@ public:
 
     /**
      * @brief Event triggered when a new connection is established (associated with an ID).
-     * 
+     *
      * The event handler will receive a pointer to the ConnectionManager object and
      * a pointer to the connected BaseConnection object.
      */
     static Event<ConnectionManager*, BaseConnection*> onConnect;
 
 private:
-    static SafeList<BaseConnection*> _connectionPool; /**< Pool of BaseConnection objects. */
+    /**
+     * @brief One entry of the table. State packs the ID (bits 0-15), the connected flag (bit 16) and the
+     * generation (bits 17-31), so a reader gets all three in one load.
+     */
+    struct ConnectionSlot {
+        std::atomic<BaseConnection*> connection{nullptr};
+        std::atomic<uint32_t> state{0};
+        uint8_t nextFree = UINT8_MAX;
+    };
+
+    static constexpr uint8_t NoSlot = UINT8_MAX;
+
+    /**
+     * @brief Entries of the ID index: a power of two at least twice the slots, so probes stay short.
+     */
+    static constexpr size_t IndexSize = [] {
+        size_t size = 1;
+        while (size < 2 * CONNECTION_MAX_CONNECTIONS) size <<= 1;
+        return size;
+    }();
+
+    static uint8_t findSlot(uint16_t id);
+
+    static void release(uint8_t slot, uint32_t state);
+
+    static std::array<ConnectionSlot, CONNECTION_MAX_CONNECTIONS> _slots; /**< Connection table. */
+    static std::array<std::atomic<uint8_t>, IndexSize> _index; /**< ID -> slot + 1, 0 empty, NoSlot removed. */
+    static std::atomic<uint8_t> _slotCount; /**< Slots taken by addConnection. */
+    static std::atomic<uint8_t> _freeHead; /**< First free slot, NoSlot if none. */
 
     // Private constructor to prevent instantiation (static class)
     ConnectionManager() = delete;
 };
 
-#endif //CONNECTIONMANAGER_H
\ No newline at end of file
+#endif //CONNECTIONMANAGER_H
@@ -0,0 +1,108 @@
+#include <esp_log.h>
+#include "freertos/FreeRTOS.h"
+#include <Metrics.h>
+#include "NotificationHub.h"
+
+static portMUX_TYPE topicsMux = portMUX_INITIALIZER_UNLOCKED;//NOLINT
+
+std::array<NotificationHub::Topic, NOTIFICATION_MAX_TOPICS> NotificationHub::_topics;//NOLINT
+std::atomic<uint8_t> NotificationHub::_topicCount{0};//NOLINT
+std::atomic<uint32_t> NotificationHub::_dirty{0};//NOLINT
+
+uint8_t NotificationHub::addTopic(const char* name, TopicSerializer serializer) {
+    portENTER_CRITICAL(&topicsMux);
+    uint8_t topic = _topicCount.load(std::memory_order_relaxed);
+    if (topic < NOTIFICATION_MAX_TOPICS) {
+        _topics[topic].name = name;
+        _topics[topic].serializer = std::move(serializer);
+        _topicCount.store(topic + 1, std::memory_order_release);
+    }
+    portEXIT_CRITICAL(&topicsMux);
+
+    if (topic >= NOTIFICATION_MAX_TOPICS) {
+        ESP_LOGE(__FUNCTION__, "Sem espaço para o tópico %s (%d)", name, NOTIFICATION_MAX_TOPICS);
+        return NoTopic;
+    }
+    return topic;
+}
+
+void NotificationHub::markDirty(uint8_t topic) {
+    if (topic >= _topicCount.load(std::memory_order_acquire)) return;
+    _dirty.fetch_or(1u << topic, std::memory_order_release);
+}
+
+void NotificationHub::subscribe(BaseConnection* connection, uint8_t topic) {
+    if (connection == nullptr || topic >= _topicCount.load(std::memory_order_acquire)) return;
+    auto& topics = connection->getNotificationTopics();
+    topics.subscribed.fetch_or(1u << topic, std::memory_order_relaxed);
+    // Quem acabou de assinar recebe o estado atual, mesmo sem mudança
+    topics.pending.fetch_or(1u << topic, std::memory_order_relaxed);
+}
+
+void NotificationHub::unsubscribe(BaseConnection* connection, uint8_t topic) {
+    if (connection == nullptr || topic >= NOTIFICATION_MAX_TOPICS) return;
+    auto& topics = connection->getNotificationTopics();
+    topics.subscribed.fetch_and(~(1u << topic), std::memory_order_relaxed);
+    topics.pending.fetch_and(~(1u << topic), std::memory_order_relaxed);
+}
+
+uint32_t NotificationHub::prepare() {
+    uint32_t changed = _dirty.exchange(0, std::memory_order_acquire);
+    for (uint8_t topic = 0; topic < NOTIFICATION_MAX_TOPICS && (changed >> topic) != 0; topic++) {
+        if (changed & (1u << topic)) {
+            serialize(_topics[topic]);
+        }
+    }
+    return changed;
+}
+
+void NotificationHub::deliver(BaseConnection* connection, uint32_t changed) {
+    static Counter& sent = Metrics::counter("notify.sent");
+    static Counter& bytes = Metrics::counter("notify.bytes");
+    static Counter& coalesced = Metrics::counter("notify.coalesced");
+
+    auto& topics = connection->getNotificationTopics();
+    uint32_t subscribed = topics.subscribed.load(std::memory_order_relaxed);
+    if (connection->getNotificationNeeds() != NotificationNeeds::NoSend) {
+        changed = subscribed;
+        connection->setNotificationNeeds(NotificationNeeds::NoSend);
+    }
+
+    // Uma mudança num tópico ainda pendente se junta a ele: só a última versão é enviada
+    uint32_t fresh = changed & subscribed;
+    uint32_t pending = topics.pending.fetch_or(fresh, std::memory_order_relaxed);
+    if (uint32_t merged = pending & fresh) {
+        coalesced.increment(__builtin_popcount(merged));
+    }
+    pending = (pending | fresh) & subscribed;
+
+    for (uint8_t topic = 0; topic < NOTIFICATION_MAX_TOPICS && (pending >> topic) != 0; topic++) {
+        uint32_t bit = 1u << topic;
+        if ((pending & bit) == 0) continue;
+
+        auto& entry = _topics[topic];
+        if (!entry.serialized) serialize(entry);
+        if (!entry.json.empty() && connection->sendJson(entry.json) != CommonErrorCodes::None) {
+            // A conexão não está dando conta; o resto fica para a próxima rodada
+            break;
+        }
+        topics.pending.fetch_and(~bit, std::memory_order_relaxed);
+        sent.increment();
+        bytes.increment(entry.json.size());
+    }
+}
+
+const char* NotificationHub::getTopicName(uint8_t topic) {
+    return topic < _topicCount.load(std::memory_order_acquire) ? _topics[topic].name : "";
+}
+
+void NotificationHub::serialize(Topic& topic) {
+    static Counter& serialized = Metrics::counter("notify.serialized");
+    static Histogram& serializeTime = Metrics::histogram("notify.serialize_us");
+
+    HistogramTimer timer(serializeTime);
+    topic.json.clear();
+    if (topic.serializer) topic.serializer(topic.json);
+    topic.serialized = true;
+    serialized.increment();
+}
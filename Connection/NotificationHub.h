@@ -0,0 +1,100 @@
+#ifndef NOTIFICATIONHUB_H
+#define NOTIFICATIONHUB_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "Delegate.h"
+#include "BaseConnection.h"
+
+/**
+ * @file NotificationHub.h
+ * @brief Defines the NotificationHub class, which fans state notifications out to the connections.
+ */
+
+#ifndef NOTIFICATION_MAX_TOPICS
+/**
+ * @brief Topics that can be registered. Each connection keeps one bit per topic.
+ */
+#define NOTIFICATION_MAX_TOPICS 16
+#endif
+
+static_assert(NOTIFICATION_MAX_TOPICS <= 32, "NotificationTopics keeps one bit per topic in 32 bits");
+
+/**
+ * @brief Writes the current state of a topic as JSON into the buffer, which comes empty.
+ */
+using TopicSerializer = Delegate<void(std::string& json)>;
+
+/**
+ * @class NotificationHub
+ * @brief Coalescing fan-out of state topics to the subscribed connections.
+ *
+ * Producers only mark a topic dirty. Once per round (ConnectionManager::sendNotifications) each dirty topic is
+ * serialized once and the same buffer is sent to every subscribed connection. A topic a connection could not
+ * send stays pending and later updates are merged into it, so a slow connection gets the latest state once
+ * instead of every intermediate one. prepare() and deliver() must run on a single task.
+ */
+class NotificationHub {
+public:
+    static constexpr uint8_t NoTopic = UINT8_MAX;
+
+    NotificationHub() = delete;
+
+    /**
+     * @brief Registers a topic. Call at startup, before the first round.
+     *
+     * @param name Static name, for logs.
+     * @param serializer Serializes the topic when it changed.
+     * @return The topic, or NoTopic if NOTIFICATION_MAX_TOPICS are already registered.
+     */
+    static uint8_t addTopic(const char* name, TopicSerializer serializer);
+
+    /**
+     * @brief Marks the topic as changed. Lock-free, from any task; marking it again before the round is free.
+     */
+    static void markDirty(uint8_t topic);
+
+    /**
+     * @brief Subscribes the connection to the topic. The current state is sent in the next round.
+     */
+    static void subscribe(BaseConnection* connection, uint8_t topic);
+
+    static void unsubscribe(BaseConnection* connection, uint8_t topic);
+
+    /**
+     * @brief Starts a round: serializes each dirty topic once.
+     *
+     * @return The topics that changed since the last round.
+     */
+    static uint32_t prepare();
+
+    /**
+     * @brief Sends the connection its pending topics, plus those that changed and it is subscribed to.
+     *
+     * A connection with NotificationNeeds other than NoSend gets all its topics again. Sending stops at the first
+     * failure; the remaining topics stay pending for the next round.
+     *
+     * @param changed The result of prepare().
+     */
+    static void deliver(BaseConnection* connection, uint32_t changed);
+
+    static const char* getTopicName(uint8_t topic);
+
+private:
+    struct Topic {
+        const char* name = nullptr;
+        TopicSerializer serializer;
+        std::string json;        /**< Last serialization, kept with its capacity. */
+        bool serialized = false;
+    };
+
+    static void serialize(Topic& topic);
+
+    static std::array<Topic, NOTIFICATION_MAX_TOPICS> _topics;
+    static std::atomic<uint8_t> _topicCount;
+    static std::atomic<uint32_t> _dirty; /**< Topics marked since the last prepare(). */
+};
+
+#endif // NOTIFICATIONHUB_H
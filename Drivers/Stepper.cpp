@@ -3,9 +3,7 @@
 //
 
 #include "Stepper.h"
-#include "priorities.h"
-
-SemaphoreHandle_t finishSteppingSem = xSemaphoreCreateBinary();;
+#include "esp_timer.h"
 
 IRAM_ATTR static void PeriodicCallback(void *arg) {
     auto *st = static_cast<Stepper *>(arg);
@@ -17,15 +15,12 @@ IRAM_ATTR static void PeriodicCallback(void *arg) {
     if (st->StepCount >= st->DesiredSteps) {
         esp_timer_stop(st->Timer);
         st->IsMoving = false;
-        xSemaphoreGive(finishSteppingSem);
-    }
-}
-
-[[noreturn]] static void OnFinishSteppingTsk(void *arg) {
-    for (;;) {
-        auto *st = static_cast<Stepper *>(arg);
-        xSemaphoreTake(finishSteppingSem, portMAX_DELAY);
-        st->OnFinishStepping.trigger();
+        // Os handlers rodam na tarefa do EventDispatcher, aqui só enfileiramos
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        st->OnFinishStepping.postFromISR(&higherPriorityTaskWoken);
+        if (higherPriorityTaskWoken == pdTRUE) {
+            esp_timer_isr_dispatch_need_yield();
+        }
     }
 }
 
@@ -34,8 +29,8 @@ void Stepper::Init() {
     Utility::SetOutput(Direction, false);
     Utility::SetOutput(Enable, false);
     SetDirection(true);
-    Utility::CreateAndProfile("OnFinishSteppingTsk", OnFinishSteppingTsk, 2048, HIGH_PRIORITY, 1,
-                              this);
+    OnFinishStepping.setDispatchPriority(EventPriority::High);
+    EventDispatcher::start();
 
     const esp_timer_create_args_t periodic_timer_args = {
             .callback = PeriodicCallback,
@@ -17,4 +17,5 @@ namespace CommonErrorCodes {
     const ErrorCode InvalidCommand = ErrorCode::define("InvalidCommand", "Invalid command received", ErrorCodeType::General);
     const ErrorCode ConnectionClosed = ErrorCode::define("ConnectionClosed", "Connection is closed", ErrorCodeType::General);
     const ErrorCode ListIsEmpty = ErrorCode::define("ListIsEmpty", "The list is empty", ErrorCodeType::General);
+    const ErrorCode Busy = ErrorCode::define("Busy", "Busy, try again later", ErrorCodeType::General);
 }
\ No newline at end of file
@@ -22,6 +22,7 @@ namespace CommonErrorCodes {
         extern const ErrorCode InvalidCommand;      /**< An invalid command was received. */
         extern const ErrorCode ConnectionClosed;     /**< The connection is closed. */
         extern const ErrorCode ListIsEmpty;          /**< The list is empty. */
+        extern const ErrorCode Busy;                 /**< No capacity left right now, the request may be retried later. */
 
 }
 
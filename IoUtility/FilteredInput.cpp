@@ -4,30 +4,41 @@
 
 #include "FilteredInput.h"
 
-uint32_t FilteredInputEx::_taskStack = 4096;
-TaskHandle_t FilteredInputEx::_inputTask = nullptr;
+uint32_t FilteredInputEx::_sampleInterval = FILTERED_INPUT_SAMPLE_MS;
+TimerHandle FilteredInputEx::_sampleTimer{};
 std::list<FilteredInputEx *> FilteredInputEx::_instances{};
 
-void FilteredInputTask(void *none) {
-    for (;;) {
-        auto instances = FilteredInputEx::GetInstances();
-        for (auto input: instances) {
-            input->ExUpdate();
-            vTaskDelay(10);
-        }
-    }
-    vTaskDelete(nullptr);
-}
-
 FilteredInputEx::FilteredInputEx(std::function<uint32_t()> readFunction, uint16_t debounce_ms)
         : FilteredInput(
         readFunction, debounce_ms) {
-    if (_inputTask == nullptr) {
-        StartTask();
+    _instances.push_back(this);
+
+    if (!_sampleTimer.isValid()) {
+        StartSampling();
     }
+}
 
-    _instances.push_back(this);
+void FilteredInputEx::StartSampling() {
+    TimerService::start();
+    EventDispatcher::start();
+    TimerService::cancel(_sampleTimer);
+    _sampleTimer = TimerService::schedulePeriodic(_sampleInterval, SampleAll);
+}
+
+/**
+ * Entrega o evento na tarefa do EventDispatcher: a amostragem roda na tarefa do TimerService, que é de todos os
+ * timers e não pode esperar um handler que bloqueia.
+ */
+static void Post(Event<FilteredInput *, void *> &event, FilteredInput *input, const char *name) {
+    if (!event.post(input, nullptr)) {
+        log_device(true, name, "Fila do EventDispatcher cheia, evento perdido");
+    }
+}
 
+void FilteredInputEx::SampleAll() {
+    for (auto input: _instances) {
+        input->ExUpdate();
+    }
 }
 
 void FilteredInputEx::ExUpdate() {
@@ -36,15 +47,15 @@ void FilteredInputEx::ExUpdate() {
     auto now = pdTICKS_TO_MS(xTaskGetTickCount());
     if (_lastState == (ActiveLow ? 0x1 : 0x0) && GetValue() == (ActiveLow ? 0x0 : 0x1) &&
         !_pressedFired) {
-        PressedEvent.trigger(this, nullptr);
+        Post(PressedEvent, this, "PressedEvent");
         _pressedFired = true;
         _clickedDetectStart = now;
     } else if (_lastState == (ActiveLow ? 0x0 : 0x1) && GetValue() == (ActiveLow ? 0x1 : 0x0) &&
                !_releasedFired) {
-        ReleasedEvent.trigger(this, nullptr);
+        Post(ReleasedEvent, this, "ReleasedEvent");
         _releasedFired = true;
         if (now - _clickedDetectStart < 1000 && !_clickedFired) {
-            ClickedEvent.trigger(this, nullptr);
+            Post(ClickedEvent, this, "ClickedEvent");
             _clickedFired = true;
         }
     } else {
@@ -11,7 +11,7 @@
 #include <functional>
 #include "Event.h"
 #include "Utility.h"
-#include "priorities.h"
+#include "TimerService.h"
 
 #ifdef STM32L1
 #include <FreeRTOS.h>
@@ -25,7 +25,9 @@
 
 #endif
 
-void FilteredInputTask(void *filteredInput);
+#ifndef FILTERED_INPUT_SAMPLE_MS
+#define FILTERED_INPUT_SAMPLE_MS 10
+#endif
 
 class FilteredInput {
 public:
@@ -71,6 +73,10 @@ class FilteredInputEx : public FilteredInput {
 public:
     FilteredInputEx(std::function<uint32_t()> readFunction, uint16_t debounce_ms);
 
+    /**
+     * Os eventos são detectados no timer de amostragem e entregues na tarefa do EventDispatcher, então os handlers
+     * podem demorar sem atrasar a leitura das entradas nem os outros timers.
+     */
     Event<FilteredInput *, void *> PressedEvent{};
     Event<FilteredInput *, void *> ReleasedEvent{};
     Event<FilteredInput *, void *> ClickedEvent{};
@@ -78,11 +84,18 @@ public:
 
     void ExUpdate();
 
+    [[deprecated("As entradas agora são amostradas pelo TimerService, use SetSampleInterval")]]
     static void SetTaskStackSize(uint32_t stackSize) {
-        _taskStack = stackSize;
-        if (_inputTask != nullptr) {
-            vTaskDelete(_inputTask);
-            StartTask();
+        (void) stackSize;
+    }
+
+    /**
+     * Intervalo entre leituras de todas as instâncias
+     */
+    static void SetSampleInterval(uint32_t interval_ms) {
+        _sampleInterval = interval_ms;
+        if (_sampleTimer.isValid()) {
+            StartSampling();
         }
     }
 
@@ -93,18 +106,16 @@ public:
     bool ActiveLow = true;
 private:
 
-    static void StartTask() {
-        Utility::CreateAndProfile("FilteredInputTask", FilteredInputTask, _taskStack, HIGH_PRIORITY,
-                                  1,
-                                  nullptr);
-    }
+    static void StartSampling();
+
+    static void SampleAll();
 
     uint32_t _lastState;
     bool _pressedFired = false;
     bool _releasedFired = false;
     bool _clickedFired = false;
-    static uint32_t _taskStack;
-    static TaskHandle_t _inputTask;
+    static uint32_t _sampleInterval;
+    static TimerHandle _sampleTimer;
     static std::list<FilteredInputEx *> _instances;
 };
 
@@ -9,6 +9,7 @@
 #include <freertos/task.h>
 #include <driver/gpio.h>
 #include "Utility.h"
+#include "TimerService.h"
 
 class LedBlinker {
 public:
@@ -19,19 +20,47 @@ public:
         Gpio = gpio;
     }
 
+    ~LedBlinker() {
+        Stop();
+    }
+
+    LedBlinker(const LedBlinker &) = delete;
+
+    LedBlinker &operator=(const LedBlinker &) = delete;
+
+    /**
+     * Pisca pelo TimerService, sem precisar chamar Update()
+     */
+    void Start() {
+        TimerService::start();
+        Stop();
+        _timer = TimerService::schedulePeriodic(pdTICKS_TO_MS(Interval), [this]() { Toggle(); });
+    }
+
+    void Stop() {
+        TimerService::cancel(_timer);
+    }
+
     void Update() {
         auto ticks = xTaskGetTickCount();
         if (ticks - LastBlink > Interval) {
-            Level = Level == 0x1 ? 0x0 : 0x1;
-            gpio_set_level(Gpio, Level);
-            LastBlink = ticks;
+            Toggle();
         }
     }
 
+    void Toggle() {
+        Level = Level == 0x1 ? 0x0 : 0x1;
+        gpio_set_level(Gpio, Level);
+        LastBlink = xTaskGetTickCount();
+    }
+
     int Level = 0x0;
     TickType_t LastBlink;
     TickType_t Interval;
     gpio_num_t Gpio;
+
+private:
+    TimerHandle _timer{};
 };
 
 
@@ -68,6 +68,63 @@ nlohmann::json JsonModels::BaseListJsonDataBasic::getPartialListJson() const {
     return j;
 }
 
+std::string JsonModels::CommandResultJson::toJson() const {
+    auto j = getPartialJson(false);
+    j["Command"] = Command;
+    return j.dump();
+}
+
+bool JsonModels::CommandResultJson::fromJson(const nlohmann::json &j) {
+    if (j.is_null()) return false;
+    try {
+        Command = j["Command"];
+    } catch (const nlohmann::json::exception &e) {
+        const char* error_msg = e.what();
+        ESP_LOGE(__FUNCTION__, "Exception: %s", error_msg);
+        return false;
+    }
+    return true;
+}
+
+std::string JsonModels::BatchResultJson::toJson() const {
+    auto j = getPartialJson(false);
+    j["Command"] = Command;
+    j["Executed"] = Executed;
+    // As respostas já são JSON: entram no texto sem serem interpretadas de novo
+    std::string text = j.dump();
+    text.pop_back();
+    text += ",\"Results\":[";
+    for (size_t i = 0; i < Results.size(); i++) {
+        text += i == 0 ? "[" : ",[";
+        for (size_t k = 0; k < Results[i].size(); k++) {
+            if (k > 0) text += ',';
+            text += Results[i][k];
+        }
+        text += ']';
+    }
+    text += "]}";
+    return text;
+}
+
+bool JsonModels::BatchResultJson::fromJson(const nlohmann::json &j) {
+    if (j.is_null() || !CommandResultJson::fromJson(j)) return false;
+    try {
+        Executed = j["Executed"];
+        Results.clear();
+        for (const auto &responses: j["Results"]) {
+            auto &item = Results.emplace_back();
+            for (const auto &response: responses) {
+                item.push_back(response.dump());
+            }
+        }
+    } catch (const nlohmann::json::exception &e) {
+        const char* error_msg = e.what();
+        ESP_LOGE(__FUNCTION__, "Exception: %s", error_msg);
+        return false;
+    }
+    return true;
+}
+
 std::string JsonModels::UuidInfoJsonData::toJson() const {
     nlohmann::json j;
     j["NotifyUUID"] = NotifyUUID;
@@ -2,6 +2,7 @@
 #define JSONMODELS_H
 
 #include <string>
+#include <vector>
 #include <nlohmann/json.hpp>
 #include <ErrorCode.h>
 #include "projectConfig.h"
@@ -165,6 +166,53 @@ namespace JsonModels {
         virtual void fromPair(Tkey first, Tvalue second) = 0;
     };
 
+    /**
+     * @class CommandResultJson
+     * @brief Represents a JSON data model for the answer Commander itself gives to a command (e.g. busy).
+     */
+    class CommandResultJson : public BaseJsonDataError {
+    public:
+        uint8_t Command = 0; /**< Code of the command being answered. */
+
+        /**
+         * @brief Converts the object to a JSON string representation.
+         * @return JSON string representation of the object.
+         */
+        [[nodiscard]] std::string toJson() const override;
+
+        /**
+         * @brief Populates the object with data from a JSON object.
+         * @param j The JSON object to extract data from.
+         * @return True if the population was successful, false otherwise.
+         */
+        [[nodiscard]] bool fromJson(const nlohmann::json &j) override;
+    };
+
+    /**
+     * @class BatchResultJson
+     * @brief Represents a JSON data model for the single answer to a batch of commands.
+     *
+     * Results holds, for each command executed, the JSON responses it sent, in order.
+     */
+    class BatchResultJson : public CommandResultJson {
+    public:
+        uint8_t Executed = 0; /**< Commands of the batch that were executed. */
+        std::vector<std::vector<std::string>> Results; /**< Responses of each executed command, already JSON. */
+
+        /**
+         * @brief Converts the object to a JSON string representation. The responses are copied as they are.
+         * @return JSON string representation of the object.
+         */
+        [[nodiscard]] std::string toJson() const override;
+
+        /**
+         * @brief Populates the object with data from a JSON object.
+         * @param j The JSON object to extract data from.
+         * @return True if the population was successful, false otherwise.
+         */
+        [[nodiscard]] bool fromJson(const nlohmann::json &j) override;
+    };
+
 #ifdef USER_MANAGEMENT_ENABLED
 
     /**
@@ -172,7 +172,7 @@ ErrorCode Storage::getEntriesFromUser(const std::string& user, std::map<int64_t,
 }
 
 ErrorCode Storage::storeUser(const JsonModels::User& user, bool overwrite) {
-    ESP_LOGI("Storage", "Storing user: %s", user.Name.c_str());
+    ESP_LOGD("Storage", "Storing user: %s", user.Name.c_str());
     if (isReservedFileName(user.Name)) {
         return CommonErrorCodes::ArgumentError;
     }
@@ -197,7 +197,7 @@ ErrorCode Storage::getAllUsers(std::map<std::string, JsonModels::User>& usersMap
 ErrorCode Storage::storeConfig(const std::string& key, const std::string& value, bool overwrite) {
     if (_fileSystemAvailable) {
         // Try to store in file system first
-        ESP_LOGI("Storage", "Storing config in file system: %s", key.c_str());
+        ESP_LOGD("Storage", "Storing config in file system: %s", key.c_str());
         ErrorCode err = storeKeyValue(key, value, StorageConstants::ConfigFilename, overwrite);
         if (err == CommonErrorCodes::None) {
             return CommonErrorCodes::None;
@@ -207,7 +207,7 @@ ErrorCode Storage::storeConfig(const std::string& key, const std::string& value,
     }
     
     // Fallback to NVS
-    ESP_LOGI("Storage", "Storing config in NVS (fallback): %s", key.c_str());
+    ESP_LOGD("Storage", "Storing config in NVS (fallback): %s", key.c_str());
     // NVS::storeValue will create the namespace automatically when opening in READWRITE mode
     return NVS::storeValue("config", key, value);
 }
@@ -238,6 +238,25 @@ ErrorCode Storage::loadConfig(const std::string& key, std::string& value) {
     return err;
 }
 
+ErrorCode Storage::storeTrace(const std::string& fileName) {
+    if (isReservedFileName(fileName)) {
+        return CommonErrorCodes::ArgumentError;
+    }
+
+    std::string filePath = getFilePath(fileName);
+    std::ofstream outputFile(filePath, std::ios::trunc);
+    if (!outputFile) {
+        ESP_LOGE("Storage", "Error opening file for writing: %s", filePath.c_str());
+        return CommonErrorCodes::FileOpenError;
+    }
+
+    Trace::writeChromeJson([&outputFile](std::string_view chunk) {
+        outputFile.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    });
+    outputFile.close();
+    return outputFile ? CommonErrorCodes::None : CommonErrorCodes::FileWriteError;
+}
+
 bool Storage::isReservedFileName(const std::string& fileName) {
     return (fileName == StorageConstants::ConfigFilename ||
             fileName == StorageConstants::UsersFilename ||
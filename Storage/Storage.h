@@ -4,7 +4,9 @@
 #include <string>
 #include <map>
 #include <fstream>
-#include <sstream>
+#include "Convert.h"
+#include "Trace.h"
+#include "Metrics.h"
 #include "CommonErrorCodes.h"
 #include "JsonModels.h"
 #include "projectConfig.h"
@@ -100,8 +102,8 @@ public:
      * and closing the file. If the key already exists in the file and `overwrite` is false,
      * the value will not be updated.
      *
-     * @tparam TKey The type of the key. The type must be serializable to a string using `std::stringstream`.
-     * @tparam TValue The type of the value. The type must be serializable to a string using `std::stringstream`.
+     * @tparam TKey The type of the key. The type must be convertible to a string with `Convert::toString`.
+     * @tparam TValue The type of the value. The type must be convertible to a string with `Convert::toString`.
      * @param key The key to store.
      * @param value The value to store.
      * @param fileName The name of the file to store the data in (without the ".txt" extension).
@@ -119,8 +121,8 @@ public:
      * This method searches the file for a line matching the format "key=value". If a matching key is found,
      * the corresponding value is parsed and stored in the `value` reference.
      *
-     * @tparam TKey The type of the key. The type must be serializable to a string using `std::stringstream`.
-     * @tparam TValue The type of the value. The type must be deserializable from a string using `std::stringstream`.
+     * @tparam TKey The type of the key. The type must be convertible to a string with `Convert::toString`.
+     * @tparam TValue The type of the value. The type must be convertible from a string with `Convert::fromString`.
      * @param key The key to search for.
      * @param value A reference to a variable that will store the read value.
      * @param fileName The name of the file to read from (without the ".txt" extension).
@@ -136,8 +138,8 @@ public:
      * If the key exists in the file, the value is read and stored in the `value` reference. If the key does not
      * exist or the file does not exist, the key-value pair is created in the file using the provided `defaultValue`.
      *
-     * @tparam TKey The type of the key. The type must be serializable to a string using `std::stringstream`.
-     * @tparam TValue The type of the value. The type must be serializable and deserializable from a string using `std::stringstream`.
+     * @tparam TKey The type of the key. The type must be convertible to a string with `Convert::toString`.
+     * @tparam TValue The type of the value. The type must be convertible to and from a string with `Convert`.
      * @param key The key to read or create.
      * @param value A reference to a variable that will store the read or created value.
      * @param fileName The name of the file to read from/write to (without the ".txt" extension).
@@ -153,8 +155,8 @@ public:
      *
      * The file is parsed line-by-line, assuming the format "key=value". Each key-value pair is added to the `dataMap`.
      *
-     * @tparam TKey The type of the key. The type must be deserializable from a string using `std::stringstream`.
-     * @tparam TValue The type of the value. The type must be deserializable from a string using `std::stringstream`.
+     * @tparam TKey The type of the key. The type must be convertible from a string with `Convert::fromString`.
+     * @tparam TValue The type of the value. The type must be convertible from a string with `Convert::fromString`.
      * @param fileName The name of the file to read from (without the ".txt" extension).
      * @param dataMap A reference to a map that will store the retrieved key-value pairs.
      * @return ErrorCode indicating success or failure. CommonErrorCodes::FileIsEmpty is returned if the file
@@ -175,6 +177,14 @@ public:
     static ErrorCode storeConfig(const std::string& key, const std::string& value, bool overwrite = true);
     static ErrorCode loadConfig(const std::string& key, std::string& value);
 
+    /**
+     * @brief Writes the trace ring as Chrome Trace Event JSON (see Trace).
+     *
+     * @param fileName The name of the file to write (without the ".txt" extension).
+     * @return ErrorCode indicating success or failure.
+     */
+    static ErrorCode storeTrace(const std::string& fileName = "trace");
+
 private:
     static uint32_t _sectorSize; /**< The sector size of the storage device. */
     static bool _fileSystemAvailable; /**< Flag indicating if file system is available. */
@@ -199,8 +209,8 @@ private:
     /**
      * @brief Stores a key-value pair in a file without checking for reserved filenames.
      *
-     * @tparam TKey The type of the key. The type must be serializable to a string using `std::stringstream`.
-     * @tparam TValue The type of the value. The type must be serializable to a string using `std::stringstream`.
+     * @tparam TKey The type of the key. The type must be convertible to a string with `Convert::toString`.
+     * @tparam TValue The type of the value. The type must be convertible to a string with `Convert::toString`.
      * @param key The key to store.
      * @param value The value to store.
      * @param fileName The name of the file to store the data in (without the extension).
@@ -225,6 +235,9 @@ ErrorCode Storage::storeKeyValue(const TKey& key, const TValue& value,
 
 template<typename TKey, typename TValue>
 ErrorCode Storage::readKeyValue(const TKey& key, TValue& value, const std::string& fileName) {
+    TraceSpan span("Storage::readKeyValue", "storage");
+    static Histogram &latency = Metrics::histogram("storage.read_us");
+    HistogramTimer timer(latency);
     std::string filePath = getFilePath(fileName);
 
     std::ifstream input(filePath);
@@ -234,27 +247,26 @@ ErrorCode Storage::readKeyValue(const TKey& key, TValue& value, const std::strin
         return CommonErrorCodes::FileOpenError;
     }
 
+    // A chave é convertida uma vez; a comparação é feita sobre as views de cada linha
+    const std::string keyText = Convert::toString(key);
     std::string line;
-    std::stringstream keyStream;
     while (std::getline(input, line)) {
-        size_t separatorPos = line.find('=');
-        if (separatorPos == std::string::npos) {
+        std::string_view lineView(line);
+        size_t separatorPos = lineView.find('=');
+        if (separatorPos == std::string_view::npos) {
             continue; // Skip lines without the separator
         }
 
-        std::string fileKey = line.substr(0, separatorPos);
-        std::string fileValue = line.substr(separatorPos + 1);
-
-        // Compare keys, using string conversion for TKey
-        keyStream << key;
-        if (fileKey == keyStream.str()) {
-            std::stringstream valueStream(fileValue);
-            valueStream >> value; // Read the value
+        if (lineView.substr(0, separatorPos) == keyText) {
+            if (Convert::fromString(lineView.substr(separatorPos + 1), value) != std::errc()) {
+                ESP_LOGW("Storage", "Invalid value for key '%s' in file: %s", keyText.c_str(), filePath.c_str());
+                return CommonErrorCodes::ArgumentError;
+            }
             return CommonErrorCodes::None;
         }
     }
 
-    ESP_LOGW("Storage", "Key '%s' not found in file: %s", keyStream.str().c_str(), filePath.c_str());
+    ESP_LOGW("Storage", "Key '%s' not found in file: %s", keyText.c_str(), filePath.c_str());
     return CommonErrorCodes::FileNotFound;
 }
 
@@ -275,6 +287,9 @@ ErrorCode Storage::readOrCreateKeyValue(const TKey& key, TValue& value,
 
 template<typename TKey, typename TValue>
 ErrorCode Storage::getEntriesFromFile(const std::string& fileName, std::map<TKey, TValue>& dataMap) {
+    TraceSpan span("Storage::getEntriesFromFile", "storage");
+    static Histogram &latency = Metrics::histogram("storage.read_us");
+    HistogramTimer timer(latency);
     std::string filePath = getFilePath(fileName);
     std::ifstream input(filePath);
     if (!input) {
@@ -291,17 +306,14 @@ ErrorCode Storage::getEntriesFromFile(const std::string& fileName, std::map<TKey
             continue; // Skip lines without separator
         }
 
-        std::string fileKey = line.substr(0, separatorPos);
-        std::string fileValue = line.substr(separatorPos + 1);
-
-        // Convert strings to TKey and TValue
-        std::stringstream keyStream(fileKey);
-        std::stringstream valueStream(fileValue);
-
-        TKey key;
-        TValue value;
-        keyStream >> key;
-        valueStream >> value;
+        std::string_view lineView(line);
+        TKey key{};
+        TValue value{};
+        if (Convert::fromString(lineView.substr(0, separatorPos), key) != std::errc() ||
+            Convert::fromString(lineView.substr(separatorPos + 1), value) != std::errc()) {
+            ESP_LOGW("Storage", "Skipping invalid line in file %s: %s", filePath.c_str(), line.c_str());
+            continue;
+        }
 
         dataMap[key] = value;
     }
@@ -317,6 +329,9 @@ ErrorCode Storage::getEntriesFromFile(const std::string& fileName, std::map<TKey
 template<typename TKey, typename TValue>
 ErrorCode Storage::storeKeyValueInternal(const TKey& key, const TValue& value,
                                          const std::string& fileName, bool overwrite) {
+    TraceSpan span("Storage::storeKeyValue", "storage");
+    static Histogram &latency = Metrics::histogram("storage.write_us");
+    HistogramTimer timer(latency);
     std::string filePath = getFilePath(fileName);
 
     // 1. Check if the key already exists
@@ -324,10 +339,8 @@ ErrorCode Storage::storeKeyValueInternal(const TKey& key, const TValue& value,
         TValue existingValue;
         ErrorCode err = readKeyValue<TKey, TValue>(key, existingValue, fileName);
         if (err == CommonErrorCodes::None) {
-            // Convert key to char* for logging
-            std::stringstream keyStream;
-            keyStream << key;
-            ESP_LOGW("Storage", "Key '%s' already exists in file: %s", keyStream.str().c_str(), fileName.c_str());
+            ESP_LOGW("Storage", "Key '%s' already exists in file: %s", Convert::toString(key).c_str(),
+                     fileName.c_str());
             return CommonErrorCodes::FileExists;
         } else if (err != CommonErrorCodes::FileNotFound && err != CommonErrorCodes::FileIsEmpty) {
             return err;
@@ -342,7 +355,7 @@ ErrorCode Storage::storeKeyValueInternal(const TKey& key, const TValue& value,
     }
 
     // 3. Write the key-value pair to the file
-    outputFile << key << "=" << value << std::endl;
+    outputFile << Convert::toString(key) << "=" << Convert::toString(value) << std::endl;
     outputFile.close();
 
     return CommonErrorCodes::None;
@@ -7,8 +7,8 @@
 
 #include "ConnectedUser.h"
 
-std::list<uint8_t> ConnectedUser::GetData() {
-    return std::list<uint8_t>();
+ByteBuffer ConnectedUser::GetData() {
+    return {};
 }
 
 NotificationNeeds ConnectedUser::GetNotificationNeeds() {
@@ -17,7 +17,7 @@
 #include <SdCard.h>
 #include <BluetoothConnection.h>
 #include "Enums.h"
-#include "list"
+#include "ByteBuffer.h"
 #include "UserManager.h"
 
 class ConnectedUser {
@@ -34,7 +34,7 @@ public:
         return this == &other;
     }
 
-    virtual std::list<uint8_t> GetData();
+    virtual ByteBuffer GetData();
 
     virtual NotificationNeeds GetNotificationNeeds();
 
@@ -14,7 +14,8 @@
 
 #define DEBUG_INFO
 
-SafeList<ConnectedUser *> UserManager::_activeUsers{};//NOLINT
+SafeList<ConnectedUser *> UserManager::_activeUsers{"ActiveUsers"};//NOLINT
+SafeList<BaseConnection *> UserManager::_watchedConnections{"WatchedConnections"};//NOLINT
 
 void UserManager::CreateManager() {
     //Adiciona os Erros
@@ -28,27 +29,27 @@ void UserManager::CreateManager() {
 
     DeviceCommand Login(2, std::string(NAMEOF(Login)), (uint8_t) CommandCode::LoginCode,
                         [this](const std::vector<std::string> &data,
-                               BluetoothConnection *connection) {
+                               BaseConnection *connection) {
                             this->Login(data, connection);
                         });
 
     const DeviceCommand Logoff(0, std::string(NAMEOF(Logoff)), (uint8_t) CommandCode::LogoffCode,
                                [this](const std::vector<std::string> &data,
-                                      BluetoothConnection *connection) {
+                                      BaseConnection *connection) {
                                    UserManager::Logoff(connection);
                                });
 
     const DeviceCommand SignUp(1, std::string(NAMEOF(SignUp)), (uint8_t) CommandCode::SignUpCode,
                                [](const std::vector<std::string> &data,
-                                  BluetoothConnection *connection) {
+                                  BaseConnection *connection) {
                                    UserManager::SignUp(data[0], connection);
-                               });
+                               }, CommandFlagSlow);
 
     const DeviceCommand GetUsersWaiting(0, std::string(
                                                 NAMEOF(
                                                         GetUsersWaiting)), (uint8_t) CommandCode::GetUsersWaitingCode,
                                         [](const std::vector<std::string> &data,
-                                           BluetoothConnection *connection) {
+                                           BaseConnection *connection) {
                                             UserManager::GetUsersWaitingForApproval(connection);
                                         });
 
@@ -56,16 +57,16 @@ void UserManager::CreateManager() {
                                             NAMEOF(
                                                     ApproveUser)), (uint8_t) CommandCode::ApproveUserCode,
                                     [](const std::vector<std::string> &data,
-                                       BluetoothConnection *connection) {
+                                       BaseConnection *connection) {
                                         UserManager::ApproveUser(data[0], connection);
-                                    });
+                                    }, CommandFlagSlow);
     const DeviceCommand ClearUsers(0, std::string(
                                            NAMEOF(
                                                    ClearUsers)), (uint8_t) CommandCode::ClearUsers,
                                    [](const std::vector<std::string> &data,
-                                      BluetoothConnection *connection) {
+                                      BaseConnection *connection) {
                                        UserManager::ClearUsers(connection);
-                                   });
+                                   }, CommandFlagSlow);
 
     Commander::AddCommand(Login);
     Commander::AddCommand(Logoff);
@@ -112,7 +113,7 @@ auto UserManager::SaveUser(const JsonModels::User &user) -> ErrorCode {//NOLINT
     return result;
 }
 
-void UserManager::SignUp(const string &jsonStr, BluetoothConnection *connection) { //NOLINT
+void UserManager::SignUp(const string &jsonStr, BaseConnection *connection) { //NOLINT
     JsonModels::User user{};
     if (!user.FromString(jsonStr)) {
         ESP_LOGE(__FUNCTION__, "Erro tentando deserializar %s como usuario", jsonStr.c_str());
@@ -139,10 +140,10 @@ void UserManager::SignUp(const string &jsonStr, BluetoothConnection *connection)
         result.IsAdmin = true;
     }
 
-    connection->SendJsonData<JsonModels::SignUpResultJson>(result);
+    connection->sendJson(result.toJson());
 }
 
-void UserManager::GetUsersWaitingForApproval(BluetoothConnection *connection) {
+void UserManager::GetUsersWaitingForApproval(BaseConnection *connection) {
     std::map<std::string, JsonModels::User> usersWaiting;
 
     auto result = Storage::GetEntriesWithFilter(StorageConst::UsersFilename, usersWaiting,
@@ -153,34 +154,34 @@ void UserManager::GetUsersWaitingForApproval(BluetoothConnection *connection) {
 
     if (result != ErrorCodes::None) {
         if (result == ErrorCodes::FileNotFound) {
-            connection->SendError<JsonModels::UserListJsonData>(ErrorCodes::NoUsersRegistered);
+            connection->sendError<JsonModels::UserListJsonData>(ErrorCodes::NoUsersRegistered);
         }
 
         return;
     }
 
-    connection->SendList<JsonModels::UserListJsonData>(usersWaiting);
+    connection->sendList<JsonModels::UserListJsonData>(usersWaiting);
 }
 
-void UserManager::ApproveUser(const string &userName, BluetoothConnection *pConnection) {//NOLINT
+void UserManager::ApproveUser(const string &userName, BaseConnection *pConnection) {//NOLINT
     JsonModels::User user{};
     auto result = LoadUser(userName, user);
     if (result != ErrorCodes::None) {
         ESP_LOGE(__FUNCTION__, "Erro Carregando o usuario %s", userName.c_str());
-        pConnection->SendError<JsonModels::BaseJsonDataError>(result);
+        pConnection->sendError<JsonModels::BaseJsonDataError>(result);
     }
 
     user.IsConfirmed = true;
     auto res = Storage::StoreUser(user, true);
     if (res != ErrorCodes::None) {
         ESP_LOGE(__FUNCTION__, "Erro gravando o usuario %s", user.Name.c_str());
-        pConnection->SendError<JsonModels::BaseJsonDataError>(res);
+        pConnection->sendError<JsonModels::BaseJsonDataError>(res);
     }
 }
 
-void UserManager::ClearUsers(BluetoothConnection *pConnection) {
+void UserManager::ClearUsers(BaseConnection *pConnection) {
     auto err = Storage::DeleteFile(StorageConst::UsersFilename);
-    pConnection->SendError<JsonModels::BaseJsonDataError>(err);
+    pConnection->sendError<JsonModels::BaseJsonDataError>(err);
 }
 
 ConnectedUser *UserManager::CreateUserInstance() {
@@ -14,14 +14,13 @@
 #include <list>
 #include <map>
 #include "BluetoothServer.h"
+#include "BaseConnection.h"
 #include <JsonModels.h>
 #include <Enums.h>
 #include <Storage.h>
 #include <SafeList.h>
 #include "ErrorCode.h"
 
-class BluetoothConnection;
-
 constexpr char AdminRegistered[] = "AdminRegistered";
 
 namespace ErrorCodes {
@@ -43,25 +42,25 @@ class UserManager {
     using string = std::string;
 public:
 
-    void Login(const std::vector<std::string> &data, BluetoothConnection *connection);
+    void Login(const std::vector<std::string> &data, BaseConnection *connection);
 
-    static void Logoff(BluetoothConnection *connection);
+    static void Logoff(BaseConnection *connection);
 
     static auto SaveUser(const JsonModels::User &user) -> ErrorCode;
 
     static ErrorCode LoadUser(const string &userName, JsonModels::User &user);
 
-    static void SignUp(const string &jsonStr, BluetoothConnection *connection);
+    static void SignUp(const string &jsonStr, BaseConnection *connection);
 
-    static void GetUsersWaitingForApproval(BluetoothConnection *connection);
+    static void GetUsersWaitingForApproval(BaseConnection *connection);
 
-    static void ApproveUser(const string &userName, BluetoothConnection *pConnection);
+    static void ApproveUser(const string &userName, BaseConnection *pConnection);
 
-    static void ClearUsers(BluetoothConnection *pConnection);
+    static void ClearUsers(BaseConnection *pConnection);
 
     static ErrorCode CheckPassword(string &userName, string &pass, bool &isAdmin);
 
-    static void SendLoginTryResult(ErrorCode errorCode, BluetoothConnection *connection);
+    static void SendLoginTryResult(ErrorCode errorCode, BaseConnection *connection);
 
     void CreateManager();
 
@@ -71,8 +70,11 @@ protected:
     virtual ConnectedUser *CreateUserInstance();
 
     static SafeList<ConnectedUser *> _activeUsers;//NOLINT
+    static SafeList<BaseConnection *> _watchedConnections;//NOLINT
     static void DeleteUser(ConnectedUser *user);
 
+    static void ReleaseOnDisconnect(BaseConnection *connection);
+
 
 };
 
@@ -12,17 +12,17 @@
 #define DEBUG_INFO
 
 void
-UserManager::Login(const std::vector<std::string> &data, BluetoothConnection *connection) {//NOLINT
+UserManager::Login(const std::vector<std::string> &data, BaseConnection *connection) {//NOLINT
 
     //Verifica admin
     std::string adminRegistered;
     auto result = Storage::LoadConfig(AdminRegistered, adminRegistered);
     if (result == ErrorCodes::KeyNotFound || result == ErrorCodes::FileNotFound ||
         adminRegistered == "false") {
-        connection->SendError<JsonModels::LoginTryResultJson>(ErrorCodes::AdminNotRegistered);
+        connection->sendError<JsonModels::LoginTryResultJson>(ErrorCodes::AdminNotRegistered);
         return;
     } else if (result != ErrorCodes::None) {
-        connection->SendError<JsonModels::LoginTryResultJson>(result);
+        connection->sendError<JsonModels::LoginTryResultJson>(result);
         return;
     }
 
@@ -32,11 +32,11 @@ UserManager::Login(const std::vector<std::string> &data, BluetoothConnection *co
         pw = data[1];
     } else {
         ESP_LOGE(__FUNCTION__, "Usuário não contem senha");
-        connection->SendError<JsonModels::LoginTryResultJson>(ErrorCodes::Error);
+        connection->sendError<JsonModels::LoginTryResultJson>(ErrorCodes::Error);
     }
 
     ConnectedUser *connectedUser = nullptr;
-    for (auto *active: _activeUsers) {
+    for (auto *active: _activeUsers.Read()) {
         if (active != nullptr && !active->User.empty() && active->User == user) {
             connectedUser = active;
             ESP_LOGI(__FUNCTION__, "Encontrado usuario travado, retomando");
@@ -56,21 +56,25 @@ UserManager::Login(const std::vector<std::string> &data, BluetoothConnection *co
         result = connectedUser->Login(isAdmin, user);
     }
 
-    connection->SetUser(connectedUser);
+    connection->setUser(connectedUser);
+    ReleaseOnDisconnect(connection);
 
-    ESP_LOGI(__FUNCTION__, "Enviando o resultado: %s", result.GetName());
+    ESP_LOGI(__FUNCTION__, "Enviando o resultado: %s", result.name().c_str());
     SendLoginTryResult(result, connection);
 }
 
-void UserManager::SendLoginTryResult(ErrorCode errorCode, BluetoothConnection *connection) {
-    auto *user = connection->GetUser(false, false);
+void UserManager::SendLoginTryResult(ErrorCode errorCode, BaseConnection *connection) {
+    auto *user = connection->getUser();
+    if (user == nullptr) {
+        ESP_LOGE(__FUNCTION__, "Conexão sem usuario");
+    }
     JsonModels::LoginTryResultJson result{};
     result.ErrorMessage = errorCode;
-    result.IsAdmin = user->IsAdmin;
+    result.IsAdmin = user != nullptr && user->IsAdmin;
 
-    auto json_str = result.ToJson();
+    auto json_str = result.toJson();
     ESP_LOGI(__FUNCTION__, "Enviando => %s", json_str.c_str());
-    connection->SendJsonData(json_str);
+    connection->sendJson(json_str);
 }
 
 
@@ -112,9 +116,32 @@ void UserManager::Disconnect(ConnectedUser *user) {
     }
 }
 
-void UserManager::Logoff(BluetoothConnection *connection) {
-    auto *connectedUser = connection->GetUser(false, false);
-    connection->Logoff();
+void UserManager::ReleaseOnDisconnect(BaseConnection *connection) {
+    for (auto *watched: _watchedConnections.Read()) {
+        if (watched == connection) {
+            return;
+        }
+    }
+
+    // As conexões não são destruídas (pool ou membro do servidor), então um handler por conexão basta
+    _watchedConnections.Push(connection);
+    connection->onDisconnect.addHandler([](BaseConnection *disconnected, void *) {
+        auto *user = disconnected->getUser();
+        disconnected->logoff();
+        if (user != nullptr) {
+            Disconnect(user);
+        }
+    }).release();
+}
+
+void UserManager::Logoff(BaseConnection *connection) {
+    auto *connectedUser = connection->getUser();
+    if (connectedUser == nullptr) {
+        ESP_LOGE(__FUNCTION__, "Nenhum usuario logado nesta conexão");
+        connection->sendError<JsonModels::BaseJsonDataError>(ErrorCodes::Error);
+        return;
+    }
+    connection->logoff();
     auto isLocked = !connectedUser->Logoff();
     if (!isLocked) {
         DeleteUser(connectedUser);
@@ -125,8 +152,7 @@ void UserManager::Logoff(BluetoothConnection *connection) {
     ESP_LOGI(__FUNCTION__, "isLocked: %u, isLockedAndLoggedOff: %u", isLocked,
              isLockedAndLoggedOff);
     error.ErrorMessage = isLockedAndLoggedOff || !isLocked ? ErrorCodes::None : ErrorCodes::Error;
-    auto json = error.ToJson();
-    connection->SendJsonData(json);
+    connection->sendJson(error.toJson());
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,323 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#ifdef STM32L1
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#elif defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#endif
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+#ifndef QUEUE_CACHE_LINE
+#ifdef ESP_PLATFORM
+#define QUEUE_CACHE_LINE 32
+#else
+#define QUEUE_CACHE_LINE 64
+#endif
+#endif
+
+/**
+ * @class QueueSignal
+ * @brief Wake-up helper used by the blocking variants of the bounded queues.
+ *
+ * The semaphore is only given when someone is actually waiting, so the non-blocking
+ * fast path never enters the kernel.
+ */
+class QueueSignal {
+public:
+    explicit QueueSignal(UBaseType_t maxCount) {
+        _semaphore = xSemaphoreCreateCountingStatic(maxCount, 0, &_buffer);
+    }
+
+    ~QueueSignal() {
+        vSemaphoreDelete(_semaphore);
+    }
+
+    QueueSignal(const QueueSignal &) = delete;
+
+    QueueSignal &operator=(const QueueSignal &) = delete;
+
+    void notify() {
+        if (_waiters.load(std::memory_order_seq_cst) > 0) {
+            xSemaphoreGive(_semaphore);
+        }
+    }
+
+    IRAM_ATTR void notifyFromISR(BaseType_t *higherPriorityTaskWoken) {
+        if (_waiters.load(std::memory_order_seq_cst) > 0) {
+            xSemaphoreGiveFromISR(_semaphore, higherPriorityTaskWoken);
+        }
+    }
+
+    /**
+     * @brief Retries the operation until it succeeds or the timeout expires.
+     * @param operation Non-blocking attempt, returns true on success.
+     * @param ticks Maximum time to wait.
+     */
+    template<typename Operation>
+    bool waitFor(Operation &&operation, TickType_t ticks) {
+        if (operation()) return true;
+
+        TickType_t start = xTaskGetTickCount();
+        _waiters.fetch_add(1, std::memory_order_seq_cst);
+        bool done = false;
+        for (;;) {
+            // Tenta de novo depois de se registrar para não perder um notify
+            if (operation()) {
+                done = true;
+                break;
+            }
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if (ticks != portMAX_DELAY && elapsed >= ticks) break;
+            TickType_t remaining = ticks == portMAX_DELAY ? portMAX_DELAY : ticks - elapsed;
+            xSemaphoreTake(_semaphore, remaining);
+        }
+        _waiters.fetch_sub(1, std::memory_order_seq_cst);
+        return done;
+    }
+
+private:
+    StaticSemaphore_t _buffer{};
+    SemaphoreHandle_t _semaphore;
+    std::atomic<uint32_t> _waiters{0};
+};
+
+/**
+ * @class MpmcQueue
+ * @brief Fixed-capacity lock-free multi-producer/multi-consumer ring buffer (Vyukov).
+ *
+ * Each cell carries a sequence number that tells producers and consumers whether it is free or filled,
+ * so tryPush/tryPop never lock and are safe from both cores. From an ISR use tryPushFromISR/tryPopFromISR,
+ * which wake blocked tasks with the FromISR API. The ISR path is placed in IRAM, so it also runs while the
+ * flash cache is disabled. Storage is inline, no heap is used after construction.
+ *
+ * @tparam T Element type, must be nothrow move constructible/assignable.
+ * @tparam Capacity Number of elements, must be a power of two.
+ */
+template<typename T, size_t Capacity>
+class MpmcQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    MpmcQueue() {
+        for (size_t i = 0; i < Capacity; i++) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue &) = delete;
+
+    MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+    /**
+     * @brief Adds an item if there is room. Never blocks.
+     * @return False if the queue is full.
+     */
+    bool tryPush(const T &item) {
+        return emplace<false>(item);
+    }
+
+    bool tryPush(T &&item) {
+        return emplace<false>(std::move(item));
+    }
+
+    /**
+     * @brief Removes the oldest item if there is one. Never blocks.
+     * @return False if the queue is empty.
+     */
+    bool tryPop(T &item) {
+        return take<false>(item);
+    }
+
+    /**
+     * @brief Adds an item, waiting up to ticks for room.
+     */
+    bool push(const T &item, TickType_t ticks = portMAX_DELAY) {
+        return _notFull.waitFor([&]() { return tryPush(item); }, ticks);
+    }
+
+    /**
+     * @brief Removes the oldest item, waiting up to ticks for one to arrive.
+     */
+    bool pop(T &item, TickType_t ticks = portMAX_DELAY) {
+        return _notEmpty.waitFor([&]() { return tryPop(item); }, ticks);
+    }
+
+    /**
+     * @brief ISR variant of tryPush that wakes blocked consumers with the FromISR API.
+     */
+    IRAM_ATTR bool tryPushFromISR(const T &item, BaseType_t *higherPriorityTaskWoken) {
+        return emplace<true>(item, higherPriorityTaskWoken);
+    }
+
+    /**
+     * @brief ISR variant of tryPop that wakes blocked producers with the FromISR API.
+     */
+    IRAM_ATTR bool tryPopFromISR(T &item, BaseType_t *higherPriorityTaskWoken) {
+        return take<true>(item, higherPriorityTaskWoken);
+    }
+
+    /**
+     * @brief Number of items at the moment of the call (approximate under contention).
+     */
+    size_t size() const {
+        size_t enqueue = _enqueuePos.load(std::memory_order_relaxed);
+        size_t dequeue = _dequeuePos.load(std::memory_order_relaxed);
+        return enqueue >= dequeue ? enqueue - dequeue : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    // FromISR escolhe a API do FreeRTOS que acorda quem espera; higherPriorityTaskWoken só é usado no ISR.
+    // Ficam na IRAM porque as variantes FromISR passam por aqui
+    template<bool FromISR, typename U>
+    IRAM_ATTR bool emplace(U &&item, BaseType_t *higherPriorityTaskWoken = nullptr) {
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = _cells[pos & (Capacity - 1)];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.item = std::forward<U>(item);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    if constexpr (FromISR) {
+                        _notEmpty.notifyFromISR(higherPriorityTaskWoken);
+                    } else {
+                        _notEmpty.notify();
+                    }
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template<bool FromISR>
+    IRAM_ATTR bool take(T &item, BaseType_t *higherPriorityTaskWoken = nullptr) {
+        size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = _cells[pos & (Capacity - 1)];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    item = std::move(cell.item);
+                    cell.sequence.store(pos + Capacity, std::memory_order_release);
+                    if constexpr (FromISR) {
+                        _notFull.notifyFromISR(higherPriorityTaskWoken);
+                    } else {
+                        _notFull.notify();
+                    }
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    Cell _cells[Capacity];
+    alignas(QUEUE_CACHE_LINE) std::atomic<size_t> _enqueuePos{0};
+    alignas(QUEUE_CACHE_LINE) std::atomic<size_t> _dequeuePos{0};
+    QueueSignal _notEmpty{Capacity};
+    QueueSignal _notFull{Capacity};
+};
+
+/**
+ * @class SpscQueue
+ * @brief Fixed-capacity wait-free single-producer/single-consumer ring buffer.
+ *
+ * Cheaper than MpmcQueue (no compare-and-swap) when exactly one context pushes and one pops,
+ * e.g. an ISR feeding a task. tryPush/tryPop are ISR-safe.
+ *
+ * @tparam T Element type.
+ * @tparam Capacity Number of elements, must be a power of two.
+ */
+template<typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue() = default;
+
+    SpscQueue(const SpscQueue &) = delete;
+
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /**
+     * @brief Adds an item if there is room. Only the producer may call it.
+     */
+    bool tryPush(const T &item) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        _items[head & (Capacity - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest item if there is one. Only the consumer may call it.
+     */
+    bool tryPop(T &item) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = std::move(_items[tail & (Capacity - 1)]);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+
+private:
+    T _items[Capacity]{};
+    alignas(QUEUE_CACHE_LINE) std::atomic<size_t> _head{0};
+    alignas(QUEUE_CACHE_LINE) std::atomic<size_t> _tail{0};
+};
+
+#endif // BOUNDEDQUEUE_H
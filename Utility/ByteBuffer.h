@@ -0,0 +1,218 @@
+//
+// Buffer de bytes contíguo com contagem de referências
+//
+
+#ifndef BYTEBUFFER_H
+#define BYTEBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifndef BYTE_BUFFER_INLINE_CAPACITY
+/**
+ * @brief Payloads up to this size are stored inside the ByteBuffer itself, without touching the heap.
+ */
+#define BYTE_BUFFER_INLINE_CAPACITY 24
+#endif
+
+/**
+ * @class ByteBuffer
+ * @brief Contiguous payload that is cheap to pass around.
+ *
+ * - Small payloads (up to BYTE_BUFFER_INLINE_CAPACITY) live inline.
+ * - Larger payloads live in one heap block shared by every copy and slice; copying a ByteBuffer or
+ *   taking a slice() only bumps an atomic reference count.
+ * - Writing through mutableData() on a shared block copies it first (copy-on-write), so the other
+ *   holders never see the change.
+ */
+class ByteBuffer {
+public:
+    static constexpr size_t InlineCapacity = BYTE_BUFFER_INLINE_CAPACITY;
+
+    ByteBuffer() = default;
+
+    /**
+     * @brief Buffer of size zeroed bytes, to be filled through mutableData().
+     */
+    explicit ByteBuffer(size_t size) {
+        allocate(size);
+        memset(mutableData(), 0, size);
+    }
+
+    ByteBuffer(const uint8_t *data, size_t size) {
+        allocate(size);
+        if (size > 0) memcpy(mutableData(), data, size);
+    }
+
+    explicit ByteBuffer(std::string_view text)
+            : ByteBuffer(reinterpret_cast<const uint8_t *>(text.data()), text.size()) {}
+
+    explicit ByteBuffer(const std::vector<uint8_t> &bytes) : ByteBuffer(bytes.data(), bytes.size()) {}
+
+    ByteBuffer(const ByteBuffer &other) {
+        copyFrom(other);
+    }
+
+    ByteBuffer(ByteBuffer &&other) noexcept {
+        moveFrom(other);
+    }
+
+    ByteBuffer &operator=(const ByteBuffer &other) {
+        if (this != &other) {
+            release();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    ByteBuffer &operator=(ByteBuffer &&other) noexcept {
+        if (this != &other) {
+            release();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    ~ByteBuffer() {
+        release();
+    }
+
+    [[nodiscard]] const uint8_t *data() const {
+        return _block != nullptr ? _block->bytes() + _offset : _inline;
+    }
+
+    /**
+     * @brief Writable pointer to the bytes. Detaches from the other holders if the block is shared.
+     */
+    uint8_t *mutableData() {
+        if (_block == nullptr) return _inline;
+        if (_block->references.load(std::memory_order_acquire) != 1) {
+            ByteBuffer copy(data(), _size);
+            *this = std::move(copy);
+            if (_block == nullptr) return _inline;
+        }
+        return _block->bytes() + _offset;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return _size;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return _size == 0;
+    }
+
+    [[nodiscard]] const uint8_t *begin() const {
+        return data();
+    }
+
+    [[nodiscard]] const uint8_t *end() const {
+        return data() + _size;
+    }
+
+    uint8_t operator[](size_t index) const {
+        return data()[index];
+    }
+
+    /**
+     * @brief View of part of the buffer. Shares the heap block, inline payloads are copied (they are small).
+     * Out of range requests are clamped.
+     */
+    [[nodiscard]] ByteBuffer slice(size_t offset, size_t length = SIZE_MAX) const {
+        if (offset > _size) offset = _size;
+        if (length > _size - offset) length = _size - offset;
+        if (_block == nullptr) return {_inline + offset, length};
+
+        ByteBuffer result;
+        result._block = _block;
+        result._offset = _offset + offset;
+        result._size = length;
+        _block->references.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    /**
+     * @brief True if another ByteBuffer holds the same heap block.
+     */
+    [[nodiscard]] bool isShared() const {
+        return _block != nullptr && _block->references.load(std::memory_order_acquire) > 1;
+    }
+
+    [[nodiscard]] std::string_view asStringView() const {
+        return {reinterpret_cast<const char *>(data()), _size};
+    }
+
+    [[nodiscard]] std::string toString() const {
+        return std::string(asStringView());
+    }
+
+    bool operator==(const ByteBuffer &other) const {
+        return _size == other._size && (_size == 0 || memcmp(data(), other.data(), _size) == 0);
+    }
+
+    bool operator!=(const ByteBuffer &other) const {
+        return !(*this == other);
+    }
+
+private:
+    struct Block {
+        std::atomic<uint32_t> references{1};
+
+        uint8_t *bytes() {
+            return reinterpret_cast<uint8_t *>(this + 1);
+        }
+    };
+
+    void allocate(size_t size) {
+        _size = size;
+        if (size <= InlineCapacity) return;
+        void *memory = ::operator new(sizeof(Block) + size);
+        _block = new(memory) Block();
+    }
+
+    void copyFrom(const ByteBuffer &other) {
+        _size = other._size;
+        _offset = other._offset;
+        _block = other._block;
+        if (_block != nullptr) {
+            _block->references.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            memcpy(_inline, other._inline, _size);
+        }
+    }
+
+    void moveFrom(ByteBuffer &other) {
+        // A referência do bloco passa para este buffer, sem mexer no contador
+        _size = other._size;
+        _offset = other._offset;
+        _block = other._block;
+        if (_block == nullptr) memcpy(_inline, other._inline, _size);
+        other._block = nullptr;
+        other._size = 0;
+        other._offset = 0;
+    }
+
+    void release() {
+        if (_block != nullptr && _block->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            _block->~Block();
+            ::operator delete(_block);
+        }
+        _block = nullptr;
+        _size = 0;
+        _offset = 0;
+    }
+
+    Block *_block = nullptr;
+    size_t _offset = 0;
+    size_t _size = 0;
+    uint8_t _inline[InlineCapacity]{};
+};
+
+#endif // BYTEBUFFER_H
@@ -0,0 +1,165 @@
+//
+// Conversões entre texto e valores sem streams
+//
+
+#ifndef CONVERT_H
+#define CONVERT_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+/**
+ * @class Convert
+ * @brief Text to value and value to text, dispatched at compile time on the type.
+ *
+ * - Integers and enums: std::from_chars / std::to_chars, base 10. A leading '+' is accepted.
+ * - Floating point: std::from_chars / std::to_chars, shortest form that reads back the same value.
+ * - bool: reads "1", "0", "true" and "false" (any case), writes "1" and "0" like the streams did.
+ * - char: a single character. int8_t and uint8_t are numbers, not characters.
+ * - std::string: copied as is.
+ * - Anything else with stream operators falls back to std::stringstream.
+ *
+ * Spaces around the text are ignored; anything else left after the value is an error.
+ */
+class Convert {
+public:
+    Convert() = delete;
+
+    /**
+     * @brief Enough room for any integer or floating point value written by toChars().
+     */
+    static constexpr size_t MaxLength = 32;
+
+    /**
+     * @brief Reads a value. On error the value is left untouched.
+     * @return std::errc() on success, invalid_argument if the text is not a T, result_out_of_range if it does not fit.
+     */
+    template<typename T>
+    static std::errc fromString(std::string_view text, T &value) {
+        text = trim(text);
+        if constexpr (std::is_same_v<T, bool>) {
+            return parseBool(text, value);
+        } else if constexpr (std::is_same_v<T, char>) {
+            if (text.size() != 1) return std::errc::invalid_argument;
+            value = text.front();
+            return {};
+        } else if constexpr (std::is_enum_v<T>) {
+            std::underlying_type_t<T> raw;
+            auto error = fromString(text, raw);
+            if (error == std::errc()) value = static_cast<T>(raw);
+            return error;
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            if (!text.empty() && text.front() == '+') text.remove_prefix(1);
+            if (text.empty()) return std::errc::invalid_argument;
+            T parsed;
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+            if (error != std::errc()) return error;
+            if (end != text.data() + text.size()) return std::errc::invalid_argument;
+            value = parsed;
+            return {};
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            value.assign(text.data(), text.size());
+            return {};
+        } else {
+            std::stringstream stream{std::string(text)};
+            T parsed;
+            if (!(stream >> parsed)) return std::errc::invalid_argument;
+            value = std::move(parsed);
+            return {};
+        }
+    }
+
+    /**
+     * @brief Reads a value, returning fallback if the text is not valid.
+     */
+    template<typename T>
+    static T fromStringOr(std::string_view text, T fallback) {
+        fromString(text, fallback);
+        return fallback;
+    }
+
+    /**
+     * @brief Writes a value into buffer, without allocating.
+     * @return The text, or an empty view if it does not fit. Strings are returned as is, without copying.
+     */
+    template<typename T>
+    static std::string_view toChars(const T &value, char *buffer, size_t capacity) {
+        if constexpr (std::is_same_v<T, bool>) {
+            if (capacity < 1) return {};
+            buffer[0] = value ? '1' : '0';
+            return {buffer, 1};
+        } else if constexpr (std::is_same_v<T, char>) {
+            if (capacity < 1) return {};
+            buffer[0] = value;
+            return {buffer, 1};
+        } else if constexpr (std::is_enum_v<T>) {
+            return toChars(static_cast<std::underlying_type_t<T>>(value), buffer, capacity);
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            auto [end, error] = std::to_chars(buffer, buffer + capacity, value);
+            if (error != std::errc()) return {};
+            return {buffer, static_cast<size_t>(end - buffer)};
+        } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+            return std::string_view(value);
+        } else {
+            static_assert(sizeof(T) == 0, "Convert::toChars needs an arithmetic, enum or string type, use toString");
+            return {};
+        }
+    }
+
+    /**
+     * @brief Writes a value into a std::string. Numbers fit in the small string buffer, so they do not allocate.
+     */
+    template<typename T>
+    static std::string toString(const T &value) {
+        if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T> ||
+                      std::is_convertible_v<const T &, std::string_view>) {
+            char buffer[MaxLength];
+            return std::string(toChars(value, buffer, sizeof(buffer)));
+        } else {
+            std::stringstream stream;
+            stream << value;
+            return stream.str();
+        }
+    }
+
+private:
+    static std::string_view trim(std::string_view text) {
+        while (!text.empty() && isSpace(text.front())) text.remove_prefix(1);
+        while (!text.empty() && isSpace(text.back())) text.remove_suffix(1);
+        return text;
+    }
+
+    static bool isSpace(char ch) {
+        return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+    }
+
+    static bool equalsIgnoreCase(std::string_view text, std::string_view expected) {
+        if (text.size() != expected.size()) return false;
+        for (size_t i = 0; i < text.size(); i++) {
+            char ch = text[i];
+            if (ch >= 'A' && ch <= 'Z') ch = static_cast<char>(ch - 'A' + 'a');
+            if (ch != expected[i]) return false;
+        }
+        return true;
+    }
+
+    static std::errc parseBool(std::string_view text, bool &value) {
+        if (text == "1" || equalsIgnoreCase(text, "true")) {
+            value = true;
+        } else if (text == "0" || equalsIgnoreCase(text, "false")) {
+            value = false;
+        } else {
+            return std::errc::invalid_argument;
+        }
+        return {};
+    }
+};
+
+#endif // CONVERT_H
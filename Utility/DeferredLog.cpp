@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <string_view>
+#include <esp_log.h>
+#include "DeferredLog.h"
+#include "BoundedQueue.h"
+#include "Utility.h"
+
+/**
+ * @file DeferredLog.cpp
+ * @brief Per-core rings of raw log records and the task that formats them.
+ */
+
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+
+namespace {
+
+struct Ring {
+    MpmcQueue<DeferredLogRecord, DEFERRED_LOG_QUEUE_SIZE> queue;
+    std::atomic<uint32_t> recorded{0};
+    std::atomic<uint32_t> dropped{0};
+};
+
+Ring rings[portNUM_PROCESSORS]; //NOLINT
+
+int currentCore() {
+#ifdef ESP_PLATFORM
+    return xPortGetCoreID();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Reads the arguments of a record in the order the format asks for them.
+ */
+class ArgReader {
+public:
+    explicit ArgReader(const DeferredLogRecord &record) : _record(record) {}
+
+    template<typename T>
+    bool read(T &value) {
+        constexpr size_t words = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+        if (_position + words > _record.words) return false;
+        memcpy(&value, _record.args + _position, sizeof(T));
+        _position += words;
+        return true;
+    }
+
+private:
+    const DeferredLogRecord &_record;
+    size_t _position = 0;
+};
+
+class Output {
+public:
+    Output(char *buffer, size_t capacity) : _buffer(buffer), _capacity(capacity) {
+        if (_capacity > 0) _buffer[0] = '\0';
+    }
+
+    void put(char ch) {
+        if (_length + 1 < _capacity) {
+            _buffer[_length] = ch;
+            _buffer[++_length] = '\0';
+        }
+    }
+
+    void puts(const char *text) {
+        while (*text != '\0') put(*text++);
+    }
+
+    template<typename T>
+    void printf(const char *spec, const int *stars, int starCount, T value) {
+        if (_length + 1 >= _capacity) return;
+        char *out = _buffer + _length;
+        size_t room = _capacity - _length;
+        int written;
+        switch (starCount) {
+            case 0:
+                written = snprintf(out, room, spec, value);
+                break;
+            case 1:
+                written = snprintf(out, room, spec, stars[0], value);
+                break;
+            default:
+                written = snprintf(out, room, spec, stars[0], stars[1], value);
+                break;
+        }
+        if (written > 0) _length += std::min(static_cast<size_t>(written), room - 1);
+    }
+
+    size_t length() const {
+        return _length;
+    }
+
+private:
+    char *_buffer;
+    size_t _capacity;
+    size_t _length = 0;
+};
+
+template<typename TSigned, typename TUnsigned>
+bool printInteger(Output &output, ArgReader &reader, const char *spec, const int *stars, int starCount,
+                  bool isSigned) {
+    if (isSigned) {
+        TSigned value;
+        if (!reader.read(value)) return false;
+        output.printf(spec, stars, starCount, value);
+    } else {
+        TUnsigned value;
+        if (!reader.read(value)) return false;
+        output.printf(spec, stars, starCount, value);
+    }
+    return true;
+}
+
+/**
+ * Prints one conversion. spec holds the whole "%...x" text.
+ */
+bool printConversion(Output &output, ArgReader &reader, const char *spec, size_t specLength, const int *stars,
+                     int starCount) {
+    char conversion = spec[specLength - 1];
+    const char *length = spec + 1;
+    while (strchr("-+ #0123456789.*", *length) != nullptr) length++;
+    std::string_view modifier(length, spec + specLength - 1 - length);
+
+    switch (conversion) {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X': {
+            bool isSigned = conversion == 'd' || conversion == 'i';
+            if (modifier == "ll") return printInteger<long long, unsigned long long>(output, reader, spec, stars,
+                                                                                   starCount, isSigned);
+            if (modifier == "l") return printInteger<long, unsigned long>(output, reader, spec, stars, starCount,
+                                                                         isSigned);
+            if (modifier == "z" || modifier == "t") {
+                return printInteger<ptrdiff_t, size_t>(output, reader, spec, stars, starCount, isSigned);
+            }
+            if (modifier == "j") return printInteger<intmax_t, uintmax_t>(output, reader, spec, stars, starCount,
+                                                                         isSigned);
+            return printInteger<int, unsigned int>(output, reader, spec, stars, starCount, isSigned);
+        }
+        case 'c': {
+            int value;
+            if (!reader.read(value)) return false;
+            output.printf(spec, stars, starCount, value);
+            return true;
+        }
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A': {
+            if (modifier == "L") return false;
+            double value;
+            if (!reader.read(value)) return false;
+            output.printf(spec, stars, starCount, value);
+            return true;
+        }
+        case 's': {
+            const void *value;
+            if (!reader.read(value)) return false;
+            output.printf(spec, stars, starCount, value != nullptr ? static_cast<const char *>(value) : "(null)");
+            return true;
+        }
+        case 'p': {
+            const void *value;
+            if (!reader.read(value)) return false;
+            output.printf(spec, stars, starCount, value);
+            return true;
+        }
+        case 'n': {
+            const void *ignored; // Não escreve na memória de quem registrou
+            return reader.read(ignored);
+        }
+        default:
+            return false;
+    }
+}
+
+char levelLetter(uint8_t level) {
+    switch (level) {
+        case ESP_LOG_ERROR:
+            return 'E';
+        case ESP_LOG_WARN:
+            return 'W';
+        case ESP_LOG_INFO:
+            return 'I';
+        case ESP_LOG_DEBUG:
+            return 'D';
+        default:
+            return 'V';
+    }
+}
+
+}
+
+TaskHandle_t DeferredLog::_task = nullptr;
+
+bool DeferredLog::start(uint32_t stack, UBaseType_t priority, int core) {
+    if (_task != nullptr) {
+        return true;
+    }
+    _task = Utility::CreateAndProfile("DeferredLogTask", logTask, stack, priority, core, nullptr);
+    return _task != nullptr;
+}
+
+void DeferredLog::push(DeferredLogRecord &record) {
+    int core = currentCore();
+    record.core = static_cast<uint8_t>(core);
+    if (_task == nullptr) {
+        print(record);
+        return;
+    }
+
+    Ring &ring = rings[core];
+    if (!ring.queue.tryPush(record)) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring.recorded.fetch_add(1, std::memory_order_relaxed);
+    // Acorda a tarefa antes de encher, sem notificar a cada registro
+    if (ring.queue.size() == DEFERRED_LOG_QUEUE_SIZE / 2) {
+        xTaskNotifyGive(_task);
+    }
+}
+
+size_t DeferredLog::format(const DeferredLogRecord &record, char *buffer, size_t capacity) {
+    Output output(buffer, capacity);
+    ArgReader reader(record);
+    const char *cursor = record.format;
+
+    while (*cursor != '\0') {
+        if (*cursor != '%') {
+            output.put(*cursor++);
+            continue;
+        }
+        if (cursor[1] == '%') {
+            output.put('%');
+            cursor += 2;
+            continue;
+        }
+
+        char spec[16];
+        size_t specLength = 0;
+        int stars[2];
+        int starCount = 0;
+        bool valid = true;
+        spec[specLength++] = *cursor++;
+        bool complete = false;
+        while (*cursor != '\0' && !complete) {
+            char ch = *cursor++;
+            if (ch == '*') {
+                if (starCount == 2 || !reader.read(stars[starCount])) valid = false;
+                starCount++;
+            }
+            if (specLength + 1 < sizeof(spec)) spec[specLength++] = ch;
+            else valid = false;
+            complete = strchr("diouxXcsfFeEgGaApn", ch) != nullptr;
+            if (!complete && strchr("-+ #0123456789.*hlLzjt", ch) == nullptr) break;
+        }
+        valid = valid && complete;
+        spec[specLength] = '\0';
+
+        if (!valid || !printConversion(output, reader, spec, specLength, stars, starCount)) {
+            output.puts("<?>");
+        }
+    }
+    return output.length();
+}
+
+void DeferredLog::print(const DeferredLogRecord &record) {
+    char line[256];
+    format(record, line, sizeof(line));
+#ifdef ESP_PLATFORM
+    esp_log_write(static_cast<esp_log_level_t>(record.level), record.tag, "%c (%lu) %s: [%u] %s\n",
+                  levelLetter(record.level), static_cast<unsigned long>(record.timestamp / 1000), record.tag,
+                  record.core, line);
+#else
+    printf("%c (%lu) %s: [%u] %s\n", levelLetter(record.level), static_cast<unsigned long>(record.timestamp / 1000),
+           record.tag, record.core, line);
+#endif
+}
+
+void DeferredLog::flush() {
+    // Junta os anéis dos núcleos pela ordem dos timestamps
+    DeferredLogRecord heads[portNUM_PROCESSORS];
+    bool loaded[portNUM_PROCESSORS];
+    for (size_t i = 0; i < portNUM_PROCESSORS; i++) {
+        loaded[i] = rings[i].queue.tryPop(heads[i]);
+    }
+
+    for (;;) {
+        int oldest = -1;
+        for (size_t i = 0; i < portNUM_PROCESSORS; i++) {
+            if (loaded[i] && (oldest < 0 || heads[i].timestamp < heads[oldest].timestamp)) {
+                oldest = static_cast<int>(i);
+            }
+        }
+        if (oldest < 0) break;
+        print(heads[oldest]);
+        loaded[oldest] = rings[oldest].queue.tryPop(heads[oldest]);
+    }
+}
+
+DeferredLogStats DeferredLog::getStats(int core) {
+    const Ring &ring = rings[core];
+    return {
+            ring.recorded.load(std::memory_order_relaxed),
+            ring.dropped.load(std::memory_order_relaxed),
+            static_cast<uint32_t>(ring.queue.size())
+    };
+}
+
+void DeferredLog::logStats() {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        auto stats = getStats(core);
+        ESP_LOGI("DeferredLog", "Nucleo %d: registrados %lu, descartados %lu, na fila %lu", core,
+                 (unsigned long) stats.recorded, (unsigned long) stats.dropped, (unsigned long) stats.depth);
+    }
+}
+
+void DeferredLog::logTask(void *arg __unused) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DEFERRED_LOG_FLUSH_MS));
+        flush();
+    }
+}
@@ -0,0 +1,207 @@
+#ifndef DEFERREDLOG_H
+#define DEFERREDLOG_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#ifdef STM32L1
+#include <FreeRTOS.h>
+#include <task.h>
+#elif defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <esp_timer.h>
+#endif
+
+#include <esp_log.h>
+
+#ifndef DEFERRED_LOG_ENABLED
+/**
+ * @brief With 0 the DLOG macros call the ESP_LOG macros directly.
+ */
+#define DEFERRED_LOG_ENABLED 1
+#endif
+
+#ifndef DEFERRED_LOG_QUEUE_SIZE
+/**
+ * @brief Records per core waiting to be formatted. Must be a power of two.
+ */
+#define DEFERRED_LOG_QUEUE_SIZE 32
+#endif
+
+#ifndef DEFERRED_LOG_MAX_WORDS
+/**
+ * @brief 32-bit words available for the arguments of one record (64-bit values and doubles take two).
+ */
+#define DEFERRED_LOG_MAX_WORDS 8
+#endif
+
+#ifndef DEFERRED_LOG_FLUSH_MS
+#define DEFERRED_LOG_FLUSH_MS 100
+#endif
+
+#ifndef DEFERRED_LOG_STACK
+#define DEFERRED_LOG_STACK 3072
+#endif
+
+#ifndef DEFERRED_LOG_PRIORITY
+#define DEFERRED_LOG_PRIORITY (tskIDLE_PRIORITY + 1)
+#endif
+
+/**
+ * @struct DeferredLogRecord
+ * @brief One log call, stored raw: pointers to the static strings plus the argument bits.
+ */
+struct DeferredLogRecord {
+    const char *tag;
+    const char *format;
+    int64_t timestamp;   /**< esp_timer_get_time() at the call, in µs */
+    uint8_t level;       /**< esp_log_level_t */
+    uint8_t core;
+    uint8_t words;       /**< Words used in args */
+    uint32_t args[DEFERRED_LOG_MAX_WORDS];
+};
+
+/**
+ * @struct DeferredLogStats
+ * @brief Counters of the ring of one core.
+ */
+struct DeferredLogStats {
+    uint32_t recorded; /**< Records accepted */
+    uint32_t dropped;  /**< Records lost because the ring was full */
+    uint32_t depth;    /**< Records waiting right now */
+};
+
+/**
+ * @class DeferredLog
+ * @brief Logging backend that moves the formatting off the calling task.
+ *
+ * A call site only stores the format pointer, a timestamp and the raw arguments into the lock-free ring
+ * of its core; a low priority task formats and prints them later, in timestamp order. Nothing is
+ * allocated and nothing is formatted on the hot path. Before start() the records are printed right away.
+ *
+ * Restrictions, since the record keeps pointers and not copies:
+ * - The tag and the format must be string literals (or otherwise live forever).
+ * - %s arguments must also outlive the record: literals, __FUNCTION__ or long-lived objects.
+ * - Only scalar arguments (integers, enums, floating point, pointers). %n and long double are not supported.
+ */
+class DeferredLog {
+public:
+    DeferredLog() = delete;
+
+    /**
+     * @brief Creates the formatting task. Calling it again has no effect.
+     */
+    static bool start(uint32_t stack = DEFERRED_LOG_STACK, UBaseType_t priority = DEFERRED_LOG_PRIORITY,
+                      int core = 0);
+
+    template<typename... Args>
+    static void write(esp_log_level_t level, const char *tag, const char *format, Args... args) {
+        constexpr size_t words = (0 + ... + wordsOf<Args>());
+        static_assert(words <= DEFERRED_LOG_MAX_WORDS, "Too many arguments for DEFERRED_LOG_MAX_WORDS");
+
+        DeferredLogRecord record;
+        record.tag = tag;
+        record.format = format;
+        record.timestamp = now();
+        record.level = level;
+        record.words = words;
+        uint32_t *out = record.args;
+        (pack(out, args), ...);
+        (void) out;
+        push(record);
+    }
+
+    /**
+     * @brief Formats and prints everything waiting now, on the calling task.
+     */
+    static void flush();
+
+    /**
+     * @brief Expands a record into text, as printf would have. Also usable by a host tool reading raw records.
+     * @return Length written (truncated to capacity - 1).
+     */
+    static size_t format(const DeferredLogRecord &record, char *buffer, size_t capacity);
+
+    static DeferredLogStats getStats(int core);
+
+    static void logStats();
+
+    /**
+     * @brief Never called, only lets the compiler check the format of the DLOG macros.
+     */
+    [[gnu::format(printf, 1, 2)]] static void checkFormat(const char */*format*/, ...) {}
+
+private:
+    template<typename T>
+    static constexpr size_t wordsOf() {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>,
+                      "DeferredLog only records scalar arguments");
+        if constexpr (std::is_floating_point_v<T>) {
+            return sizeof(double) / sizeof(uint32_t);
+        } else {
+            return (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+        }
+    }
+
+    // Mesma promoção do printf: inteiros pequenos viram int, float vira double
+    template<typename T>
+    static void pack(uint32_t *&out, T value) {
+        if constexpr (std::is_floating_point_v<T>) {
+            auto promoted = static_cast<double>(value);
+            memcpy(out, &promoted, sizeof(promoted));
+        } else if constexpr (std::is_pointer_v<T>) {
+            auto pointer = reinterpret_cast<const void *>(value);
+            memcpy(out, &pointer, sizeof(pointer));
+        } else if constexpr (sizeof(T) < sizeof(uint32_t)) {
+            *out = std::is_signed_v<T> ? static_cast<uint32_t>(static_cast<int32_t>(value))
+                                       : static_cast<uint32_t>(value);
+        } else {
+            memcpy(out, &value, sizeof(value));
+        }
+        out += wordsOf<T>();
+    }
+
+    static int64_t now() {
+#ifdef ESP_PLATFORM
+        return esp_timer_get_time();
+#else
+        return static_cast<int64_t>(xTaskGetTickCount()) * portTICK_PERIOD_MS * 1000;
+#endif
+    }
+
+    static void push(DeferredLogRecord &record);
+
+    static void print(const DeferredLogRecord &record);
+
+    static void logTask(void *arg);
+
+    static TaskHandle_t _task;
+};
+
+#if DEFERRED_LOG_ENABLED
+
+#define DLOG_LEVEL(level, tag, format, ...) do {                                           \
+        if (LOG_LOCAL_LEVEL >= (level)) {                                                  \
+            if (false) DeferredLog::checkFormat(format, ##__VA_ARGS__);                    \
+            DeferredLog::write(level, tag, format, ##__VA_ARGS__);                         \
+        }                                                                                  \
+    } while (0)
+
+#define DLOGE(tag, format, ...) DLOG_LEVEL(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define DLOGW(tag, format, ...) DLOG_LEVEL(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define DLOGI(tag, format, ...) DLOG_LEVEL(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define DLOGD(tag, format, ...) DLOG_LEVEL(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+
+#else
+
+#define DLOGE(tag, format, ...) ESP_LOGE(tag, format, ##__VA_ARGS__)
+#define DLOGW(tag, format, ...) ESP_LOGW(tag, format, ##__VA_ARGS__)
+#define DLOGI(tag, format, ...) ESP_LOGI(tag, format, ##__VA_ARGS__)
+#define DLOGD(tag, format, ...) ESP_LOGD(tag, format, ##__VA_ARGS__)
+
+#endif
+
+#endif // DEFERREDLOG_H
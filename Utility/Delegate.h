@@ -0,0 +1,139 @@
+#ifndef DELEGATE_H
+#define DELEGATE_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifndef DELEGATE_DEFAULT_CAPACITY
+/**
+ * @brief Default inline storage (in bytes) of a Delegate.
+ *
+ * Fits a lambda capturing up to four pointers, a plain function pointer or a std::function.
+ * Can be overridden at build time with -DDELEGATE_DEFAULT_CAPACITY=<bytes>.
+ */
+#define DELEGATE_DEFAULT_CAPACITY (4 * sizeof(void *))
+#endif
+
+template<typename Signature, size_t Capacity = DELEGATE_DEFAULT_CAPACITY>
+class Delegate;
+
+/**
+ * @class Delegate
+ * @brief Move-only callable wrapper with fixed inline storage (small-buffer only, never allocates).
+ *
+ * Any callable (lambda, functor, function pointer) whose size is up to Capacity bytes is stored
+ * in place. Bigger callables are rejected at compile time instead of falling back to the heap.
+ *
+ * @tparam R Return type.
+ * @tparam Args Argument types.
+ * @tparam Capacity Inline storage size in bytes.
+ */
+template<typename R, typename... Args, size_t Capacity>
+class Delegate<R(Args...), Capacity> {
+public:
+    /**
+     * @brief Creates an empty delegate.
+     */
+    Delegate() = default;
+
+    /**
+     * @brief Creates a delegate holding the given callable.
+     * @param function The callable to store. Must fit in Capacity bytes.
+     */
+    template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Delegate>>>
+    Delegate(F &&function) { // NOLINT(google-explicit-constructor)
+        assign(std::forward<F>(function));
+    }
+
+    Delegate(const Delegate &) = delete;
+
+    Delegate &operator=(const Delegate &) = delete;
+
+    Delegate(Delegate &&other) noexcept {
+        moveFrom(other);
+    }
+
+    Delegate &operator=(Delegate &&other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    ~Delegate() {
+        reset();
+    }
+
+    /**
+     * @brief Destroys the stored callable, leaving the delegate empty.
+     */
+    void reset() {
+        if (_manage != nullptr) {
+            _manage(Operation::Destroy, _storage, nullptr);
+        }
+        _invoke = nullptr;
+        _manage = nullptr;
+    }
+
+    /**
+     * @brief Checks whether a callable is stored.
+     */
+    explicit operator bool() const {
+        return _invoke != nullptr;
+    }
+
+    /**
+     * @brief Calls the stored callable. The delegate must not be empty.
+     */
+    R operator()(Args... args) const {
+        return _invoke(_storage, std::forward<Args>(args)...);
+    }
+
+private:
+    enum class Operation {
+        Move,
+        Destroy
+    };
+
+    using Invoker = R (*)(void *, Args...);
+    using Manager = void (*)(Operation, void *, void *);
+
+    template<typename F>
+    void assign(F &&function) {
+        using Callable = std::decay_t<F>;
+        static_assert(sizeof(Callable) <= Capacity,
+                      "Callable too big for the Delegate inline storage, reduce the captures or raise the capacity");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t), "Callable alignment not supported");
+        static_assert(std::is_nothrow_move_constructible_v<Callable>, "Callable must be nothrow move constructible");
+
+        new(_storage) Callable(std::forward<F>(function));
+        _invoke = [](void *storage, Args... args) -> R {
+            return (*static_cast<Callable *>(storage))(std::forward<Args>(args)...);
+        };
+        _manage = [](Operation operation, void *destination, void *source) {
+            if (operation == Operation::Move) {
+                new(destination) Callable(std::move(*static_cast<Callable *>(source)));
+            }
+            static_cast<Callable *>(operation == Operation::Move ? source : destination)->~Callable();
+        };
+    }
+
+    void moveFrom(Delegate &other) {
+        if (other._manage != nullptr) {
+            other._manage(Operation::Move, _storage, other._storage);
+        }
+        _invoke = other._invoke;
+        _manage = other._manage;
+        other._invoke = nullptr;
+        other._manage = nullptr;
+    }
+
+    alignas(std::max_align_t) mutable unsigned char _storage[Capacity]{};
+    Invoker _invoke = nullptr;
+    Manager _manage = nullptr;
+};
+
+#endif // DELEGATE_H
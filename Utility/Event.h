@@ -1,9 +1,15 @@
 #ifndef EVENT_H
 #define EVENT_H
 
-#include <functional>
-#include <vector>
-#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "Delegate.h"
+#include "EventDispatcher.h"
+#include "CrossPlatformUtility.h"
 
 #ifdef STM32L1
 #include <FreeRTOS.h>
@@ -15,16 +21,119 @@
 #include "freertos/semphr.h"
 #endif
 
+#ifndef EVENT_MAX_HANDLERS
+/**
+ * @brief Maximum number of handlers registered at the same time on a single Event.
+ *
+ * Can be overridden at build time with -DEVENT_MAX_HANDLERS=<n>.
+ */
+#define EVENT_MAX_HANDLERS 4
+#endif
+
+/**
+ * @class EventSubscription
+ * @brief Token returned by Event::addHandler. Removes the handler when destroyed (RAII).
+ *
+ * The token is move-only and must not outlive the Event that created it.
+ * Call release() to keep the handler registered for the whole lifetime of the Event.
+ */
+class EventSubscription {
+public:
+    using Unsubscriber = void (*)(void *owner, uint32_t id);
+
+    /**
+     * @brief Creates an empty (inactive) subscription.
+     */
+    EventSubscription() = default;
+
+    /**
+     * @brief Creates an active subscription.
+     * @param owner The Event that holds the handler.
+     * @param id The handler id inside the Event.
+     * @param unsubscribe Function that removes the handler from the owner.
+     */
+    EventSubscription(void *owner, uint32_t id, Unsubscriber unsubscribe)
+            : _owner(owner), _id(id), _unsubscribe(unsubscribe) {}
+
+    EventSubscription(const EventSubscription &) = delete;
+
+    EventSubscription &operator=(const EventSubscription &) = delete;
+
+    EventSubscription(EventSubscription &&other) noexcept
+            : _owner(other._owner), _id(other._id), _unsubscribe(other._unsubscribe) {
+        other.release();
+    }
+
+    EventSubscription &operator=(EventSubscription &&other) noexcept {
+        if (this != &other) {
+            reset();
+            _owner = other._owner;
+            _id = other._id;
+            _unsubscribe = other._unsubscribe;
+            other.release();
+        }
+        return *this;
+    }
+
+    ~EventSubscription() {
+        reset();
+    }
+
+    /**
+     * @brief Removes the handler from the Event now.
+     */
+    void reset() {
+        if (_unsubscribe != nullptr) {
+            _unsubscribe(_owner, _id);
+        }
+        release();
+    }
+
+    /**
+     * @brief Detaches the token, the handler stays registered until the Event is destroyed.
+     */
+    void release() {
+        _owner = nullptr;
+        _id = 0;
+        _unsubscribe = nullptr;
+    }
+
+    /**
+     * @brief Checks whether this token still owns a registered handler.
+     */
+    [[nodiscard]] bool isActive() const {
+        return _unsubscribe != nullptr;
+    }
+
+    /**
+     * @brief Returns the handler id inside the Event (0 when inactive).
+     */
+    [[nodiscard]] uint32_t id() const {
+        return _id;
+    }
+
+private:
+    void *_owner = nullptr;
+    uint32_t _id = 0;
+    Unsubscriber _unsubscribe = nullptr;
+};
+
 /**
  * @class Event
  * @brief Manages events and their handlers.
  *
  * This class allows you to register handlers (callbacks) that are called when the event is triggered.
- * Handlers can be added or removed dynamically. The class is thread-safe.
+ * Handlers are stored in a fixed table of EVENT_MAX_HANDLERS small-buffer delegates, so subscribing
+ * and triggering never touch the heap. The class is thread-safe.
+ *
+ * Besides trigger(), which runs the handlers on the calling task, post() and postFromISR() defer the
+ * call to the EventDispatcher task. A posted Event must outlive its pending records.
  */
 template <typename... Args>
 class Event {
 public:
+    using Handler = Delegate<void(Args...)>;
+
     /**
      * @brief Constructor.
      */
@@ -35,17 +144,22 @@ public:
      */
     ~Event();
 
+    Event(const Event &) = delete;
+
+    Event &operator=(const Event &) = delete;
+
     /**
      * @brief Adds a handler to the event.
      * @param handler The function to be called when the event is triggered.
+     * @return Subscription token, the handler is removed when it is destroyed. Inactive if the table is full.
      */
-    void addHandler(std::function<void(Args...)> handler);
+    [[nodiscard]] EventSubscription addHandler(Handler handler);
 
     /**
      * @brief Removes a handler from the event.
-     * @param handler The function to be removed.
+     * @param subscription The token returned by addHandler.
      */
-    void removeHandler(std::function<void(Args...)> handler);
+    void removeHandler(EventSubscription &subscription);
 
     /**
      * @brief Triggers the event, calling all registered handlers.
@@ -53,8 +167,54 @@ public:
      */
     void trigger(Args... args);
 
+    /**
+     * @brief Queues the event to be triggered on the EventDispatcher task.
+     *
+     * Arguments are copied into the record, so they must be trivially copyable and fit in
+     * EVENT_POST_PAYLOAD_SIZE bytes.
+     *
+     * @param args Arguments to pass to the handlers.
+     * @return False if the dispatcher lane is full.
+     */
+    bool post(Args... args);
+
+    /**
+     * @brief Same as post(), callable from ISR context. Placed in IRAM like EventDispatcher::postFromISR.
+     * @param args Arguments to pass to the handlers.
+     * @param higherPriorityTaskWoken Set to pdTRUE if a context switch should be requested.
+     * @return False if the dispatcher lane is full.
+     */
+    bool postFromISR(Args... args, BaseType_t *higherPriorityTaskWoken);
+
+    /**
+     * @brief Sets the dispatcher lane used by post() and postFromISR().
+     */
+    void setDispatchPriority(EventPriority priority) {
+        dispatchPriority = priority;
+    }
+
+    /**
+     * @brief Returns the number of registered handlers.
+     */
+    size_t handlerCount();
+
 private:
-    std::vector<std::function<void(Args...)>> handlers; /**< List of event handlers */
+    struct Slot {
+        uint32_t id = 0;  /**< Handler id, 0 means the slot is free */
+        Handler handler;
+    };
+
+    using Payload = std::tuple<std::decay_t<Args>...>;
+
+    static void unsubscribe(void *owner, uint32_t id);
+
+    static void invokePosted(void *target, const void *payload);
+
+    EventRecord makeRecord(Args... args);
+
+    Slot handlers[EVENT_MAX_HANDLERS]; /**< Table of event handlers */
+    uint32_t nextId = 1;               /**< Next handler id, never 0 */
+    EventPriority dispatchPriority = EventPriority::Normal; /**< Lane used by post() */
 
 #ifdef STM32L1
     SemaphoreHandle_t mutex; /**< Mutex to make the class thread-safe */
@@ -63,6 +223,12 @@ private:
 #endif
 };
 
+/**
+ * @brief Event without arguments, under the old name. Only the name is kept: the old AddListener, RemoveListener
+ * and FireEvent are gone, use addHandler (keeping the EventSubscription), removeHandler and trigger.
+ */
+using NakedEvent = Event<>;
+
 #ifdef STM32L1
 #define CREATE_MUTEX() xSemaphoreCreateMutex()
 #define DELETE_MUTEX(mutex) vSemaphoreDelete(mutex)
@@ -96,23 +262,37 @@ Event<Args...>::~Event() {
 /**
  * @brief Adds a handler to the event.
  * @param handler The function to be called when the event is triggered.
+ * @return Subscription token, the handler is removed when it is destroyed.
  */
 template <typename... Args>
-void Event<Args...>::addHandler(std::function<void(Args...)> handler) {
+EventSubscription Event<Args...>::addHandler(Handler handler) {
+    uint32_t id = 0;
     TAKE_MUTEX(mutex);
-    handlers.push_back(handler);
+    for (auto &slot : handlers) {
+        if (slot.id == 0) {
+            id = nextId++;
+            if (nextId == 0) nextId = 1;
+            slot.id = id;
+            slot.handler = std::move(handler);
+            break;
+        }
+    }
     GIVE_MUTEX(mutex);
+
+    if (id == 0) {
+        log_device(true, __FUNCTION__, "Sem espaco para handlers (max %d)", EVENT_MAX_HANDLERS);
+        return {};
+    }
+    return {this, id, &Event::unsubscribe};
 }
 
 /**
  * @brief Removes a handler from the event.
- * @param handler The function to be removed.
+ * @param subscription The token returned by addHandler.
  */
 template <typename... Args>
-void Event<Args...>::removeHandler(std::function<void(Args...)> handler) {
-    TAKE_MUTEX(mutex);
-    handlers.erase(std::remove(handlers.begin(), handlers.end(), handler), handlers.end());
-    GIVE_MUTEX(mutex);
+void Event<Args...>::removeHandler(EventSubscription &subscription) {
+    subscription.reset();
 }
 
 /**
@@ -122,10 +302,89 @@ void Event<Args...>::removeHandler(std::function<void(Args...)> handler) {
 template <typename... Args>
 void Event<Args...>::trigger(Args... args) {
     TAKE_MUTEX(mutex);
-    for (auto& handler : handlers) {
-        handler(args...);
+    for (auto &slot : handlers) {
+        if (slot.id != 0) {
+            slot.handler(args...);
+        }
+    }
+    GIVE_MUTEX(mutex);
+}
+
+/**
+ * @brief Queues the event to be triggered on the EventDispatcher task.
+ * @param args Arguments to pass to the handlers.
+ */
+template <typename... Args>
+bool Event<Args...>::post(Args... args) {
+    return EventDispatcher::post(makeRecord(args...), dispatchPriority);
+}
+
+/**
+ * @brief Same as post(), callable from ISR context.
+ * @param args Arguments to pass to the handlers.
+ * @param higherPriorityTaskWoken Set to pdTRUE if a context switch should be requested.
+ */
+template <typename... Args>
+IRAM_ATTR bool Event<Args...>::postFromISR(Args... args, BaseType_t *higherPriorityTaskWoken) {
+    return EventDispatcher::postFromISR(makeRecord(args...), dispatchPriority, higherPriorityTaskWoken);
+}
+
+/**
+ * @brief Packs the arguments into a dispatcher record. In IRAM because postFromISR() uses it.
+ */
+template <typename... Args>
+IRAM_ATTR EventRecord Event<Args...>::makeRecord(Args... args) {
+    static_assert((std::is_trivially_copyable_v<std::decay_t<Args>> && ...),
+                  "Posted event arguments must be trivially copyable");
+    static_assert(sizeof(Payload) <= EVENT_POST_PAYLOAD_SIZE, "Posted event arguments exceed EVENT_POST_PAYLOAD_SIZE");
+    static_assert(alignof(Payload) <= alignof(EventRecord), "Posted event arguments alignment not supported");
+
+    EventRecord record{};
+    record.invoke = &Event::invokePosted;
+    record.target = this;
+    new(record.payload) Payload(args...);
+    return record;
+}
+
+/**
+ * @brief Unpacks a dispatcher record and triggers the event, runs on the EventDispatcher task.
+ */
+template <typename... Args>
+void Event<Args...>::invokePosted(void *target, const void *payload) {
+    auto *self = static_cast<Event *>(target);
+    const auto &arguments = *std::launder(static_cast<const Payload *>(payload));
+    std::apply([self](const auto &... values) { self->trigger(values...); }, arguments);
+}
+
+/**
+ * @brief Returns the number of registered handlers.
+ */
+template <typename... Args>
+size_t Event<Args...>::handlerCount() {
+    size_t count = 0;
+    TAKE_MUTEX(mutex);
+    for (auto &slot : handlers) {
+        if (slot.id != 0) count++;
     }
     GIVE_MUTEX(mutex);
+    return count;
+}
+
+/**
+ * @brief Removes the handler with the given id, called by EventSubscription.
+ */
+template <typename... Args>
+void Event<Args...>::unsubscribe(void *owner, uint32_t id) {
+    auto *self = static_cast<Event *>(owner);
+    TAKE_MUTEX(self->mutex);
+    for (auto &slot : self->handlers) {
+        if (slot.id == id) {
+            slot.id = 0;
+            slot.handler.reset();
+            break;
+        }
+    }
+    GIVE_MUTEX(self->mutex);
 }
 
 #endif // EVENT_H
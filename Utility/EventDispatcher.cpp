@@ -0,0 +1,123 @@
+#include <atomic>
+#include <esp_log.h>
+#include "EventDispatcher.h"
+#include "BoundedQueue.h"
+#include "Utility.h"
+
+/**
+ * @file EventDispatcher.cpp
+ * @brief Lock-free lanes and the shared task that delivers posted events.
+ */
+
+namespace {
+
+/**
+ * Dispatcher lane: a lock-free ring plus its counters. ISRs never block on it.
+ */
+struct Lane {
+    MpmcQueue<EventRecord, EVENT_DISPATCHER_QUEUE_SIZE> queue;
+    std::atomic<uint32_t> posted{0};
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<uint32_t> dispatched{0};
+    std::atomic<uint32_t> maxDepth{0};
+
+    bool push(const EventRecord &record) {
+        return count(queue.tryPush(record));
+    }
+
+    IRAM_ATTR bool pushFromISR(const EventRecord &record, BaseType_t *higherPriorityTaskWoken) {
+        return count(queue.tryPushFromISR(record, higherPriorityTaskWoken));
+    }
+
+    // Também chamado do ISR, por isso fica na IRAM
+    IRAM_ATTR bool count(bool pushed) {
+        if (!pushed) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        posted.fetch_add(1, std::memory_order_relaxed);
+        auto depth = static_cast<uint32_t>(queue.size());
+        uint32_t max = maxDepth.load(std::memory_order_relaxed);
+        while (depth > max && !maxDepth.compare_exchange_weak(max, depth, std::memory_order_relaxed)) {}
+        return true;
+    }
+};
+
+Lane lanes[EventPriorityCount]; //NOLINT
+
+}
+
+TaskHandle_t EventDispatcher::_task = nullptr;
+
+bool EventDispatcher::start(uint32_t stack, UBaseType_t priority, int core) {
+    if (_task != nullptr) {
+        return true;
+    }
+    _task = Utility::CreateAndProfile("EventDispatcherTask", dispatchTask, stack, priority, core, nullptr);
+    return _task != nullptr;
+}
+
+bool EventDispatcher::post(const EventRecord &record, EventPriority priority) {
+    if (!lanes[static_cast<size_t>(priority)].push(record)) {
+        return false;
+    }
+    if (_task != nullptr) {
+        xTaskNotifyGive(_task);
+    }
+    return true;
+}
+
+IRAM_ATTR bool EventDispatcher::postFromISR(const EventRecord &record, EventPriority priority,
+                                  BaseType_t *higherPriorityTaskWoken) {
+    if (!lanes[static_cast<size_t>(priority)].pushFromISR(record, higherPriorityTaskWoken)) {
+        return false;
+    }
+    if (_task != nullptr) {
+        vTaskNotifyGiveFromISR(_task, higherPriorityTaskWoken);
+    }
+    return true;
+}
+
+EventQueueStats EventDispatcher::getStats(EventPriority priority) {
+    const Lane &lane = lanes[static_cast<size_t>(priority)];
+    return {
+            lane.posted.load(std::memory_order_relaxed),
+            lane.dropped.load(std::memory_order_relaxed),
+            lane.dispatched.load(std::memory_order_relaxed),
+            static_cast<uint32_t>(lane.queue.size()),
+            lane.maxDepth.load(std::memory_order_relaxed)
+    };
+}
+
+void EventDispatcher::logStats() {
+    static const char *names[EventPriorityCount] = {"High", "Normal", "Low"};
+    for (size_t i = 0; i < EventPriorityCount; i++) {
+        auto stats = getStats(static_cast<EventPriority>(i));
+        ESP_LOGI("EventDispatcher", "%s: postados %lu, descartados %lu, entregues %lu, fila %lu (max %lu)", names[i],
+                 (unsigned long) stats.posted, (unsigned long) stats.dropped, (unsigned long) stats.dispatched,
+                 (unsigned long) stats.depth, (unsigned long) stats.maxDepth);
+    }
+}
+
+void EventDispatcher::dispatchTask(void *arg __unused) {
+    // Esvazia antes de esperar: registros postados antes do start() não notificaram ninguém
+    for (;;) {
+        // Sempre recomeça pela fila de maior prioridade depois de cada entrega
+        bool delivered = true;
+        while (delivered) {
+            delivered = false;
+            for (auto &lane: lanes) {
+                EventRecord record{};
+                if (lane.queue.tryPop(record)) {
+                    record.invoke(record.target, record.payload);
+                    lane.dispatched.fetch_add(1, std::memory_order_relaxed);
+                    delivered = true;
+                    break;
+                }
+            }
+        }
+
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
@@ -0,0 +1,124 @@
+#ifndef EVENTDISPATCHER_H
+#define EVENTDISPATCHER_H
+
+#include <cstdint>
+#include <cstddef>
+
+#ifdef STM32L1
+#include <FreeRTOS.h>
+#include <task.h>
+#elif defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#endif
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+#ifndef EVENT_POST_PAYLOAD_SIZE
+/**
+ * @brief Bytes available for the arguments of a posted event (Event::post / Event::postFromISR).
+ */
+#define EVENT_POST_PAYLOAD_SIZE 16
+#endif
+
+#ifndef EVENT_DISPATCHER_QUEUE_SIZE
+/**
+ * @brief Records per priority lane of the dispatcher. Must be a power of two.
+ */
+#define EVENT_DISPATCHER_QUEUE_SIZE 32
+#endif
+
+#ifndef EVENT_DISPATCHER_STACK
+#define EVENT_DISPATCHER_STACK 4096
+#endif
+
+#ifndef EVENT_DISPATCHER_PRIORITY
+#define EVENT_DISPATCHER_PRIORITY (configMAX_PRIORITIES - 2)
+#endif
+
+/**
+ * @enum EventPriority
+ * @brief Dispatch lane of a posted event. Higher lanes are always drained first.
+ */
+enum class EventPriority : uint8_t {
+    High = 0,
+    Normal = 1,
+    Low = 2
+};
+
+constexpr size_t EventPriorityCount = 3;
+
+/**
+ * @struct EventRecord
+ * @brief Compact, trivially copyable record of a deferred event call.
+ */
+struct EventRecord {
+    void (*invoke)(void *target, const void *payload); /**< Unpacks the payload and triggers the target */
+    void *target;                                      /**< The Event to trigger */
+    alignas(8) uint8_t payload[EVENT_POST_PAYLOAD_SIZE]; /**< Copy of the event arguments */
+};
+
+/**
+ * @struct EventQueueStats
+ * @brief Counters of a dispatcher lane.
+ */
+struct EventQueueStats {
+    uint32_t posted;     /**< Records accepted */
+    uint32_t dropped;    /**< Records rejected because the lane was full */
+    uint32_t dispatched; /**< Records delivered to their handlers */
+    uint32_t depth;      /**< Records waiting right now */
+    uint32_t maxDepth;   /**< Highest depth seen */
+};
+
+/**
+ * @class EventDispatcher
+ * @brief Shared task that delivers events posted from tasks or ISRs.
+ *
+ * Posting only copies an EventRecord into a lock-free lane and notifies the dispatcher task,
+ * so it is bounded and safe from ISR context. Handlers run later on the dispatcher task.
+ */
+class EventDispatcher {
+public:
+    EventDispatcher() = delete;
+
+    /**
+     * @brief Creates the dispatcher task. Calling it again has no effect.
+     * @return True if the task is running.
+     */
+    static bool start(uint32_t stack = EVENT_DISPATCHER_STACK, UBaseType_t priority = EVENT_DISPATCHER_PRIORITY,
+                      int core = 1);
+
+    /**
+     * @brief Queues a record from task context.
+     * @return False if the lane is full (the record is dropped).
+     */
+    static bool post(const EventRecord &record, EventPriority priority);
+
+    /**
+     * @brief Queues a record from ISR context. The path is placed in IRAM, so it can be called from ESP_TIMER_ISR
+     * callbacks and ISRs registered with ESP_INTR_FLAG_IRAM.
+     * @param higherPriorityTaskWoken Set to pdTRUE if a context switch should be requested.
+     * @return False if the lane is full (the record is dropped).
+     */
+    static bool postFromISR(const EventRecord &record, EventPriority priority, BaseType_t *higherPriorityTaskWoken);
+
+    /**
+     * @brief Returns the counters of a lane.
+     */
+    static EventQueueStats getStats(EventPriority priority);
+
+    /**
+     * @brief Logs the counters of every lane.
+     */
+    static void logStats();
+
+private:
+    static void dispatchTask(void *arg);
+
+    static TaskHandle_t _task;
+};
+
+#endif // EVENTDISPATCHER_H
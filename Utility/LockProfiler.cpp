@@ -0,0 +1,119 @@
+#include <esp_log.h>
+#include <nlohmann/json.hpp>
+#include "LockProfiler.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_rom_sys.h>
+
+static portMUX_TYPE registryMux = portMUX_INITIALIZER_UNLOCKED;
+#define REGISTRY_ENTER() portENTER_CRITICAL(&registryMux)
+#define REGISTRY_EXIT() portEXIT_CRITICAL(&registryMux)
+#else
+#define REGISTRY_ENTER() taskENTER_CRITICAL()
+#define REGISTRY_EXIT() taskEXIT_CRITICAL()
+#endif
+
+/**
+ * @file LockProfiler.cpp
+ * @brief Registry of the profiled locks. Critical sections here only link/unlink or copy, never log.
+ */
+
+LockProfile *LockProfiler::_first = nullptr;
+
+LockProfile::LockProfile(const char *name) {
+    _stats.name = name;
+    LockProfiler::add(this);
+}
+
+LockProfile::~LockProfile() {
+    LockProfiler::remove(this);
+}
+
+void LockProfiler::add(LockProfile *profile) {
+    REGISTRY_ENTER();
+    profile->_next = _first;
+    _first = profile;
+    REGISTRY_EXIT();
+}
+
+void LockProfiler::remove(LockProfile *profile) {
+    REGISTRY_ENTER();
+    for (LockProfile **link = &_first; *link != nullptr; link = &(*link)->_next) {
+        if (*link == profile) {
+            *link = profile->_next;
+            break;
+        }
+    }
+    REGISTRY_EXIT();
+}
+
+uint64_t LockProfiler::toMicros(uint64_t clock) {
+#ifdef ESP_PLATFORM
+    return clock / esp_rom_get_cpu_ticks_per_us();
+#else
+    return clock * portTICK_PERIOD_MS * 1000;
+#endif
+}
+
+uint64_t LockProfiler::unwrap(const LockStamp &from, const LockStamp &to) {
+    uint32_t cycles = to.time - from.time;
+#ifdef ESP_PLATFORM
+    // Os ticks dão o tempo com erro de um tick, bem menos que meia volta; o contador dá a parte fina
+    uint64_t cyclesPerTick = static_cast<uint64_t>(esp_rom_get_cpu_ticks_per_us()) * portTICK_PERIOD_MS * 1000;
+    uint64_t coarse = static_cast<uint64_t>(static_cast<TickType_t>(to.tick - from.tick)) * cyclesPerTick;
+    if (coarse <= cycles) return cycles;
+    uint64_t wraps = (coarse - cycles + (1ull << 31)) >> 32;
+    return (wraps << 32) + cycles;
+#else
+    return cycles;
+#endif
+}
+
+std::vector<LockStats> LockProfiler::snapshot() {
+    std::vector<LockStats> result;
+    // Conta primeiro para não alocar dentro da seção crítica
+    size_t count = 0;
+    REGISTRY_ENTER();
+    for (LockProfile *profile = _first; profile != nullptr; profile = profile->_next) count++;
+    REGISTRY_EXIT();
+
+    result.resize(count);
+    size_t copied = 0;
+    REGISTRY_ENTER();
+    for (LockProfile *profile = _first; profile != nullptr && copied < count; profile = profile->_next) {
+        result[copied++] = profile->_stats;
+    }
+    REGISTRY_EXIT();
+    result.resize(copied);
+    return result;
+}
+
+nlohmann::json LockProfiler::toJson() {
+    nlohmann::json locks = nlohmann::json::array();
+    for (const auto &stats: snapshot()) {
+        locks.push_back({
+                                {"name",               stats.name != nullptr ? stats.name : ""},
+                                {"acquisitions",       stats.acquisitions},
+                                {"sharedAcquisitions", stats.sharedAcquisitions},
+                                {"timeouts",           stats.timeouts},
+                                {"waitTotalUs",        toMicros(stats.waitTotal)},
+                                {"waitMaxUs",          toMicros(stats.waitMax)},
+                                {"holdTotalUs",        toMicros(stats.holdTotal)},
+                                {"holdMaxUs",          toMicros(stats.holdMax)},
+                                {"lastHolder",         stats.lastHolder}
+                        });
+    }
+    return locks;
+}
+
+void LockProfiler::logStats() {
+    for (const auto &stats: snapshot()) {
+        ESP_LOGI("LockProfiler", "%s: %lu travas (%lu leitura), %lu timeouts, espera %llu us (max %llu), "
+                                 "posse %llu us (max %llu), ultimo: %s",
+                 stats.name != nullptr ? stats.name : "?", (unsigned long) stats.acquisitions,
+                 (unsigned long) stats.sharedAcquisitions, (unsigned long) stats.timeouts,
+                 (unsigned long long) toMicros(stats.waitTotal), (unsigned long long) toMicros(stats.waitMax),
+                 (unsigned long long) toMicros(stats.holdTotal), (unsigned long long) toMicros(stats.holdMax),
+                 stats.lastHolder);
+    }
+}
@@ -0,0 +1,184 @@
+#ifndef LOCKPROFILER_H
+#define LOCKPROFILER_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifdef STM32L1
+#include <FreeRTOS.h>
+#include <task.h>
+#elif defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_cpu.h>
+#endif
+
+// Só a declaração: o LockableContainer inclui este header e não precisa do resto da biblioteca
+#include <nlohmann/json_fwd.hpp>
+
+#ifndef LOCK_PROFILING
+/**
+ * @brief Enables the contention counters of LockableContainer. Costs a cycle-counter read and a few
+ * additions per lock, so it is meant to stay on in field builds; define as 0 to compile it out.
+ */
+#define LOCK_PROFILING 1
+#endif
+
+/**
+ * @struct LockStamp
+ * @brief Clock reading taken by LockProfiler::now(). The core is kept because cycle counters are per core, and
+ * the tick count because the 32-bit cycle counter wraps (every ~18 s at 240 MHz).
+ */
+struct LockStamp {
+    uint32_t time;
+    uint32_t core;
+    TickType_t tick;
+};
+
+/**
+ * @struct LockStats
+ * @brief Counters of one lock. Times are in clock units, see LockProfiler::toMicros().
+ */
+struct LockStats {
+    const char *name;                       /**< Name given to the container */
+    uint32_t acquisitions;                  /**< Exclusive (writer) acquisitions */
+    uint32_t sharedAcquisitions;            /**< Shared (reader) acquisitions */
+    uint32_t timeouts;                      /**< Lock attempts that gave up */
+    uint64_t waitTotal;                     /**< Time spent waiting for the lock */
+    uint64_t waitMax;
+    uint64_t holdTotal;                     /**< Time the exclusive lock was held */
+    uint64_t holdMax;
+    char lastHolder[configMAX_TASK_NAME_LEN]; /**< Task that took the exclusive lock last */
+};
+
+/**
+ * @class LockProfile
+ * @brief Counters of one lock, registered in LockProfiler for as long as it lives.
+ *
+ * The update methods must be called while the profiled mutex is held, so the counters need no lock of their own.
+ */
+class LockProfile {
+public:
+    explicit LockProfile(const char *name);
+
+    ~LockProfile();
+
+    LockProfile(const LockProfile &) = delete;
+
+    LockProfile &operator=(const LockProfile &) = delete;
+
+    void setName(const char *name) {
+        _stats.name = name;
+    }
+
+    const LockStats &stats() const {
+        return _stats;
+    }
+
+    void acquired(const LockStamp &requested, bool exclusive);
+
+    void released();
+
+    void timedOut() {
+        _stats.timeouts++;
+    }
+
+private:
+    friend class LockProfiler;
+
+    LockStats _stats{};
+    LockStamp _heldSince{};
+    LockProfile *_next = nullptr;
+};
+
+/**
+ * @class LockProfiler
+ * @brief Registry of every profiled lock.
+ */
+class LockProfiler {
+public:
+    LockProfiler() = delete;
+
+    static LockStamp now() {
+#ifdef ESP_PLATFORM
+        return {static_cast<uint32_t>(esp_cpu_get_cycle_count()), static_cast<uint32_t>(xPortGetCoreID()),
+                xTaskGetTickCount()};
+#else
+        TickType_t tick = xTaskGetTickCount();
+        return {static_cast<uint32_t>(tick), 0, tick};
+#endif
+    }
+
+    /**
+     * @brief Time between two stamps. Fails if the task moved to the other core in between.
+     */
+    static bool elapsed(const LockStamp &from, const LockStamp &to, uint64_t &elapsed) {
+        if (from.core != to.core) return false;
+        elapsed = static_cast<uint32_t>(to.time - from.time);
+#ifdef ESP_PLATFORM
+        // Abaixo disso o contador de ciclos não pode ter dado a volta, mesmo a 400 MHz
+        if (static_cast<TickType_t>(to.tick - from.tick) >= pdMS_TO_TICKS(10000)) {
+            elapsed = unwrap(from, to);
+        }
+#endif
+        return true;
+    }
+
+    static uint64_t toMicros(uint64_t clock);
+
+    /**
+     * @brief Time between two stamps far enough apart for the cycle counter to have wrapped, in cycles.
+     */
+    static uint64_t unwrap(const LockStamp &from, const LockStamp &to);
+
+    /**
+     * @brief Copies the counters of every registered lock.
+     */
+    static std::vector<LockStats> snapshot();
+
+    /**
+     * @brief Counters of every registered lock, times in microseconds.
+     */
+    static nlohmann::json toJson();
+
+    static void logStats();
+
+private:
+    friend class LockProfile;
+
+    static void add(LockProfile *profile);
+
+    static void remove(LockProfile *profile);
+
+    static LockProfile *_first;
+};
+
+inline void LockProfile::acquired(const LockStamp &requested, bool exclusive) {
+    LockStamp now = LockProfiler::now();
+    uint64_t wait;
+    if (LockProfiler::elapsed(requested, now, wait)) {
+        _stats.waitTotal += wait;
+        if (wait > _stats.waitMax) _stats.waitMax = wait;
+    }
+    if (!exclusive) {
+        _stats.sharedAcquisitions++;
+        return;
+    }
+    _stats.acquisitions++;
+    _heldSince = now;
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    if (task != nullptr) {
+        strncpy(_stats.lastHolder, pcTaskGetName(task), sizeof(_stats.lastHolder) - 1);
+    }
+}
+
+inline void LockProfile::released() {
+    uint64_t hold;
+    if (LockProfiler::elapsed(_heldSince, LockProfiler::now(), hold)) {
+        _stats.holdTotal += hold;
+        if (hold > _stats.holdMax) _stats.holdMax = hold;
+    }
+}
+
+#endif // LOCKPROFILER_H
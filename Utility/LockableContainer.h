@@ -8,29 +8,91 @@
 #ifdef STM32L1
 
 #include <FreeRTOS.h>
+#include <task.h>
 #include <semphr.h>
 
 #define MEDIUM_PRIORITY 4
 #elif defined(ESP_PLATFORM)
 
 #include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <freertos/semphr.h>
 #include "CrossPlatformUtility.h"
 
 #endif
 
+#include <atomic>
+#include <cstdint>
+#include "LockProfiler.h"
+
+/**
+ * Base for the thread-safe containers.
+ *
+ * Lock()/Unlock() give exclusive (writer) access. LockShared()/UnlockShared() give shared (reader) access:
+ * any number of readers proceed in parallel, a writer waits for the active readers to leave and blocks
+ * new ones while it waits, so writers are not starved.
+ *
+ * With LOCK_PROFILING every container shows up in LockProfiler with its wait/hold times under the given name.
+ */
 class LockableContainer {
 public:
+    explicit LockableContainer(const char *lockName = "container")
+#if LOCK_PROFILING
+            : _profile(lockName)
+#endif
+    {
+        (void) lockName;
+    }
+
+    LockableContainer(const LockableContainer &) = delete;
+
+    LockableContainer &operator=(const LockableContainer &) = delete;
+
     bool IsLocked() const {
         return _isLocked;
     }
 
+    /**
+     * Number of readers currently holding the shared lock.
+     */
+    uint32_t ReaderCount() const {
+        return _readers.load(std::memory_order_relaxed);
+    }
+
+#if LOCK_PROFILING
+
+    const LockStats &LockStatistics() const {
+        return _profile.stats();
+    }
+
+#endif
+
 protected:
     bool Lock() {
-        auto res = xSemaphoreTake(_mutex, 1000) == pdPASS;
+#if LOCK_PROFILING
+        LockStamp requested = LockProfiler::now();
+#endif
+        TickType_t start = xTaskGetTickCount();
+        auto res = xSemaphoreTake(_mutex, LockTimeout) == pdPASS;
+        // Com o mutex em mãos nenhum leitor novo entra, espera os atuais saírem
+        while (res && _readers.load(std::memory_order_acquire) > 0) {
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if (elapsed >= LockTimeout) {
+                xSemaphoreGive(_mutex);
+                res = false;
+                break;
+            }
+            xSemaphoreTake(_noReaders, LockTimeout - elapsed);
+        }
         if (res) {
             _isLocked = true;
+#if LOCK_PROFILING
+            _profile.acquired(requested, true);
+#endif
         } else {
+#if LOCK_PROFILING
+            _profile.timedOut();
+#endif
             log_device(true, __FUNCTION__, "Falha Obtendo Trava");
         }
 
@@ -39,13 +101,48 @@ protected:
 
     void Unlock() {
         if (!_isLocked) return;
-        xSemaphoreGive(_mutex);
         _isLocked = false;
+#if LOCK_PROFILING
+        _profile.released();
+#endif
+        xSemaphoreGive(_mutex);
+    }
+
+    bool LockShared() {
+#if LOCK_PROFILING
+        LockStamp requested = LockProfiler::now();
+#endif
+        if (xSemaphoreTake(_mutex, LockTimeout) != pdPASS) {
+#if LOCK_PROFILING
+            _profile.timedOut(); // Sem o mutex, contagem aproximada
+#endif
+            log_device(true, __FUNCTION__, "Falha Obtendo Trava de leitura");
+            return false;
+        }
+        _readers.fetch_add(1, std::memory_order_acquire);
+#if LOCK_PROFILING
+        _profile.acquired(requested, false);
+#endif
+        xSemaphoreGive(_mutex);
+        return true;
+    }
+
+    void UnlockShared() {
+        if (_readers.fetch_sub(1, std::memory_order_release) == 1) {
+            xSemaphoreGive(_noReaders);
+        }
     }
 
 private:
+    static constexpr TickType_t LockTimeout = 1000;
+
     SemaphoreHandle_t _mutex = xSemaphoreCreateMutex();
+    SemaphoreHandle_t _noReaders = xSemaphoreCreateBinary();
+    std::atomic<uint32_t> _readers{0};
     bool _isLocked = false;
+#if LOCK_PROFILING
+    LockProfile _profile;
+#endif
 
 };
 
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cstring>
+#include <esp_log.h>
+#include "Metrics.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_heap_caps.h>
+#endif
+
+/**
+ * @file Metrics.cpp
+ * @brief Name tables of the metrics registry and their export.
+ */
+
+#ifdef ESP_PLATFORM
+static portMUX_TYPE metricsMux = portMUX_INITIALIZER_UNLOCKED;
+#define METRICS_ENTER() portENTER_CRITICAL(&metricsMux)
+#define METRICS_EXIT() portEXIT_CRITICAL(&metricsMux)
+#else
+#define METRICS_ENTER() taskENTER_CRITICAL()
+#define METRICS_EXIT() taskEXIT_CRITICAL()
+#endif
+
+namespace {
+
+/**
+ * Metrics of one kind, looked up by name. The slots are never released, so references stay valid forever.
+ */
+template<typename T, size_t Capacity>
+struct Table {
+    const char *names[Capacity]{};
+    T metrics[Capacity];
+    T overflow; // Compartilhado pelos nomes que não couberam
+    size_t used = 0;
+
+    T &find(const char *name, const char *kind) {
+        bool full = false;
+        T *found = nullptr;
+        METRICS_ENTER();
+        for (size_t i = 0; i < used && found == nullptr; i++) {
+            if (strcmp(names[i], name) == 0) found = &metrics[i];
+        }
+        if (found == nullptr) {
+            if (used < Capacity) {
+                names[used] = name;
+                found = &metrics[used++];
+            } else {
+                found = &overflow;
+                full = true;
+            }
+        }
+        METRICS_EXIT();
+        if (full) {
+            ESP_LOGW("Metrics", "Sem espaco para %s \"%s\"", kind, name);
+        }
+        return *found;
+    }
+
+    template<typename Function>
+    void forEach(Function &&function) {
+        METRICS_ENTER();
+        size_t count = used;
+        METRICS_EXIT();
+        for (size_t i = 0; i < count; i++) function(names[i], metrics[i]);
+    }
+};
+
+Table<Counter, METRICS_CAPACITY> counters; //NOLINT
+Table<Gauge, METRICS_CAPACITY> gauges; //NOLINT
+Table<Histogram, METRICS_HISTOGRAM_CAPACITY> histograms; //NOLINT
+
+}
+
+uint32_t Histogram::percentile(double fraction) const {
+    uint32_t total = count();
+    if (total == 0) return 0;
+    auto rank = static_cast<uint32_t>(fraction * total + 0.5);
+    if (rank < 1) rank = 1;
+    uint32_t seen = 0;
+    uint32_t maximum = _max.load(std::memory_order_relaxed);
+    for (size_t bucket = 0; bucket < BucketCount; bucket++) {
+        seen += _buckets[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(upperBoundOf(bucket), maximum);
+    }
+    return maximum;
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+    return {count(), percentile(0.5), percentile(0.9), percentile(0.99), _max.load(std::memory_order_relaxed)};
+}
+
+void Histogram::reset() {
+    for (auto &bucket: _buckets) bucket.store(0, std::memory_order_relaxed);
+    _count.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+TimerHandle Metrics::_sampleTimer{};
+
+Counter &Metrics::counter(const char *name) {
+    return counters.find(name, "contador");
+}
+
+Gauge &Metrics::gauge(const char *name) {
+    return gauges.find(name, "medidor");
+}
+
+Histogram &Metrics::histogram(const char *name) {
+    return histograms.find(name, "histograma");
+}
+
+void Metrics::sample() {
+#ifdef ESP_PLATFORM
+    static Gauge &heapFree = gauge("heap.free");
+    static Gauge &heapMinFree = gauge("heap.min_free");
+    heapFree.set(static_cast<int32_t>(heap_caps_get_free_size(MALLOC_CAP_DEFAULT)));
+    heapMinFree.set(static_cast<int32_t>(heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT)));
+#endif
+}
+
+bool Metrics::startSampling(uint32_t periodMs) {
+    TimerService::start();
+    TimerService::cancel(_sampleTimer);
+    sample();
+    _sampleTimer = TimerService::schedulePeriodic(periodMs, sample);
+    return _sampleTimer.isValid();
+}
+
+void Metrics::stopSampling() {
+    TimerService::cancel(_sampleTimer);
+}
+
+void Metrics::reset() {
+    counters.forEach([](const char *, Counter &counter) { counter.reset(); });
+    gauges.forEach([](const char *, Gauge &gauge) { gauge.reset(); });
+    histograms.forEach([](const char *, Histogram &histogram) { histogram.reset(); });
+}
+
+nlohmann::json Metrics::toJson() {
+    nlohmann::json result = {
+            {"counters",   nlohmann::json::object()},
+            {"gauges",     nlohmann::json::object()},
+            {"histograms", nlohmann::json::object()}
+    };
+    counters.forEach([&result](const char *name, Counter &counter) {
+        result["counters"][name] = counter.value();
+    });
+    gauges.forEach([&result](const char *name, Gauge &gauge) {
+        result["gauges"][name] = {{"value", gauge.value()}, {"max", gauge.max()}};
+    });
+    histograms.forEach([&result](const char *name, Histogram &histogram) {
+        auto snapshot = histogram.snapshot();
+        result["histograms"][name] = {
+                {"count", snapshot.count},
+                {"p50",   snapshot.p50},
+                {"p90",   snapshot.p90},
+                {"p99",   snapshot.p99},
+                {"max",   snapshot.max}
+        };
+    });
+    return result;
+}
+
+void Metrics::logStats() {
+    counters.forEach([](const char *name, Counter &counter) {
+        ESP_LOGI("Metrics", "%s: %lu", name, (unsigned long) counter.value());
+    });
+    gauges.forEach([](const char *name, Gauge &gauge) {
+        ESP_LOGI("Metrics", "%s: %ld (max %ld)", name, (long) gauge.value(), (long) gauge.max());
+    });
+    histograms.forEach([](const char *name, Histogram &histogram) {
+        auto snapshot = histogram.snapshot();
+        ESP_LOGI("Metrics", "%s: %lu amostras, p50 %lu, p90 %lu, p99 %lu, max %lu", name,
+                 (unsigned long) snapshot.count, (unsigned long) snapshot.p50, (unsigned long) snapshot.p90,
+                 (unsigned long) snapshot.p99, (unsigned long) snapshot.max);
+    });
+}
@@ -0,0 +1,247 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef STM32L1
+#include <FreeRTOS.h>
+#include <task.h>
+#elif defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <esp_timer.h>
+#endif
+
+#include <nlohmann/json.hpp>
+#include "TimerService.h"
+
+#ifndef METRICS_CAPACITY
+/**
+ * @brief Counters and gauges that can be registered, each. Names registered after it is full share a dummy.
+ */
+#define METRICS_CAPACITY 24
+#endif
+
+#ifndef METRICS_HISTOGRAM_CAPACITY
+/**
+ * @brief Histograms that can be registered. Each one takes about 500 bytes.
+ */
+#define METRICS_HISTOGRAM_CAPACITY 8
+#endif
+
+#ifndef METRICS_SAMPLE_MS
+#define METRICS_SAMPLE_MS 5000
+#endif
+
+/**
+ * @class Counter
+ * @brief Monotonic count, incremented from any task or core.
+ */
+class Counter {
+public:
+    void increment(uint32_t amount = 1) {
+        _value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint32_t value() const {
+        return _value.load(std::memory_order_relaxed);
+    }
+
+    void reset() {
+        _value.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint32_t> _value{0};
+};
+
+/**
+ * @class Gauge
+ * @brief Current value of something (a queue depth, free memory), with the highest value seen.
+ */
+class Gauge {
+public:
+    void set(int32_t value) {
+        _value.store(value, std::memory_order_relaxed);
+        updateMax(value);
+    }
+
+    void add(int32_t amount) {
+        updateMax(_value.fetch_add(amount, std::memory_order_relaxed) + amount);
+    }
+
+    [[nodiscard]] int32_t value() const {
+        return _value.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] int32_t max() const {
+        return _max.load(std::memory_order_relaxed);
+    }
+
+    void reset() {
+        _max.store(value(), std::memory_order_relaxed);
+    }
+
+private:
+    void updateMax(int32_t value) {
+        int32_t current = _max.load(std::memory_order_relaxed);
+        while (value > current && !_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+    std::atomic<int32_t> _value{0};
+    std::atomic<int32_t> _max{0};
+};
+
+/**
+ * @struct HistogramSnapshot
+ * @brief Summary of a histogram. Percentiles are the upper bound of their bucket (at most 25% above the real
+ * value) and never above max.
+ */
+struct HistogramSnapshot {
+    uint32_t count;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max;
+};
+
+/**
+ * @class Histogram
+ * @brief Fixed-memory log-linear histogram of 32-bit values (latencies in µs).
+ *
+ * Values below 4 have a bucket each; above that every power of two is split in 4 linear buckets,
+ * so the relative error is bounded by 25% across the whole range.
+ */
+class Histogram {
+public:
+    static constexpr uint32_t SubBits = 2;
+    static constexpr uint32_t SubBuckets = 1u << SubBits;
+    static constexpr size_t BucketCount = (32 - SubBits + 1) * SubBuckets;
+
+    void record(uint32_t value) {
+        _buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        uint32_t current = _max.load(std::memory_order_relaxed);
+        while (value > current && !_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+    [[nodiscard]] uint32_t count() const {
+        return _count.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Value below which the given fraction (0 to 1) of the records falls.
+     */
+    [[nodiscard]] uint32_t percentile(double fraction) const;
+
+    [[nodiscard]] HistogramSnapshot snapshot() const;
+
+    void reset();
+
+    static constexpr size_t bucketOf(uint32_t value) {
+        if (value < SubBuckets) return value;
+        uint32_t exponent = 31 - __builtin_clz(value);
+        uint32_t mantissa = (value >> (exponent - SubBits)) & (SubBuckets - 1);
+        return (exponent - SubBits + 1) * SubBuckets + mantissa;
+    }
+
+    /**
+     * @brief Highest value that falls in the bucket.
+     */
+    static constexpr uint32_t upperBoundOf(size_t bucket) {
+        if (bucket < SubBuckets) return static_cast<uint32_t>(bucket);
+        uint32_t exponent = static_cast<uint32_t>(bucket / SubBuckets) + SubBits - 1;
+        uint32_t mantissa = static_cast<uint32_t>(bucket % SubBuckets);
+        uint64_t lower = static_cast<uint64_t>(SubBuckets + mantissa) << (exponent - SubBits);
+        return static_cast<uint32_t>(lower + (1ull << (exponent - SubBits)) - 1);
+    }
+
+private:
+    std::atomic<uint32_t> _buckets[BucketCount]{};
+    std::atomic<uint32_t> _count{0};
+    std::atomic<uint32_t> _max{0};
+};
+
+static_assert(Histogram::bucketOf(UINT32_MAX) == Histogram::BucketCount - 1, "Histogram buckets do not cover uint32_t");
+static_assert(Histogram::upperBoundOf(Histogram::bucketOf(1000)) >= 1000, "Histogram bucket bounds are inconsistent");
+
+/**
+ * @class Metrics
+ * @brief Registry of named counters, gauges and histograms.
+ *
+ * Looking a name up takes a short critical section, so call sites keep the reference:
+ * @code
+ * static Histogram &latency = Metrics::histogram("storage.latency_us");
+ * @endcode
+ * After that every update is a relaxed atomic, safe from any task or core. Names must be static strings.
+ */
+class Metrics {
+public:
+    Metrics() = delete;
+
+    static Counter &counter(const char *name);
+
+    static Gauge &gauge(const char *name);
+
+    static Histogram &histogram(const char *name);
+
+    /**
+     * @brief Time in µs, as used by HistogramTimer.
+     */
+    static int64_t now() {
+#ifdef ESP_PLATFORM
+        return esp_timer_get_time();
+#else
+        return static_cast<int64_t>(xTaskGetTickCount()) * portTICK_PERIOD_MS * 1000;
+#endif
+    }
+
+    /**
+     * @brief Updates the system gauges ("heap.free" and "heap.min_free").
+     */
+    static void sample();
+
+    /**
+     * @brief Samples periodically on the TimerService. Calling it again changes the period.
+     */
+    static bool startSampling(uint32_t periodMs = METRICS_SAMPLE_MS);
+
+    static void stopSampling();
+
+    /**
+     * @brief Zeroes counters and histograms and restarts the gauge maxima from the current value.
+     */
+    static void reset();
+
+    static nlohmann::json toJson();
+
+    static void logStats();
+
+private:
+    static TimerHandle _sampleTimer;
+};
+
+/**
+ * @class HistogramTimer
+ * @brief Records the µs spent in its own scope into a histogram.
+ */
+class HistogramTimer {
+public:
+    explicit HistogramTimer(Histogram &histogram) : _histogram(histogram), _start(Metrics::now()) {}
+
+    ~HistogramTimer() {
+        _histogram.record(static_cast<uint32_t>(Metrics::now() - _start));
+    }
+
+    HistogramTimer(const HistogramTimer &) = delete;
+
+    HistogramTimer &operator=(const HistogramTimer &) = delete;
+
+private:
+    Histogram &_histogram;
+    int64_t _start;
+};
+
+#endif // METRICS_H
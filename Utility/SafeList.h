@@ -19,6 +19,7 @@
 #endif
 
 #include <list>
+#include <vector>
 #include "functional"
 #include "LockableContainer.h"
 #include "CrossPlatformUtility.h"
@@ -26,12 +27,52 @@
 template<class T>
 class SafeList : public LockableContainer {
 public:
+    /**
+     * Scoped read access to the list. Holds the shared lock while alive, so several readers
+     * iterate in parallel and the lock is always released, even on break/return.
+     *
+     *     for (auto *item : list.Read()) { ... }
+     */
+    class ReadView {
+    public:
+        explicit ReadView(SafeList &owner) : _owner(owner), _locked(owner.LockShared()) {}
+
+        ~ReadView() {
+            if (_locked) _owner.UnlockShared();
+        }
+
+        ReadView(const ReadView &) = delete;
+
+        ReadView &operator=(const ReadView &) = delete;
+
+        /**
+         * False if the shared lock could not be taken, in which case the view is empty.
+         */
+        [[nodiscard]] bool IsValid() const {
+            return _locked;
+        }
+
+        typename std::list<T>::const_iterator begin() const {
+            return _locked ? _owner._list.cbegin() : _owner._list.cend();
+        }
+
+        typename std::list<T>::const_iterator end() const {
+            return _owner._list.cend();
+        }
+
+    private:
+        SafeList &_owner;
+        bool _locked;
+    };
+
     SafeList() = default;
 
+    explicit SafeList(const char *lockName) : LockableContainer(lockName) {}
+
     auto Empty() -> bool {
-        if (Lock()) {
+        if (LockShared()) {
             bool empty = _list.empty();
-            Unlock();
+            UnlockShared();
             return empty;
         }
         return true;
@@ -40,49 +81,43 @@ public:
 
     T PopFront() {
         T result{};
-        if (_isIterating) {
-            log_device(true, __FUNCTION__, "Nao pode modificar a lista enquanto a itera");
-            return result;
-        }
-
         if (Lock()) {
-            result = _list.front();
-            _list.pop_front();
+            if (!_list.empty()) {
+                result = _list.front();
+                _list.pop_front();
+            }
             Unlock();
         }
         return result;
     }
 
     void Push(T item) {
-        if (_isIterating) {
-            log_device(true, __FUNCTION__, "Nao pode modificar a lista enquanto a itera");
-            return;
-        }
         if (Lock()) {
             _list.push_back(item);
             Unlock();
         }
     }
 
-    typename std::list<T>::iterator begin() {
-        if (Lock()) {
-            _isIterating = true;
-            return _list.begin();
-        }
-        return _list.end();
+    /**
+     * Iterates under the shared lock. The list must not be modified by the same task while the view is alive.
+     */
+    ReadView Read() {
+        return ReadView(*this);
     }
 
-    typename std::list<T>::iterator end() {
-        Unlock();
-        _isIterating = false;
-        return _list.end();
+    /**
+     * Copies the items under the shared lock, so the caller can iterate (and block) without holding any lock.
+     */
+    std::vector<T> Snapshot() {
+        std::vector<T> items;
+        if (LockShared()) {
+            items.assign(_list.begin(), _list.end());
+            UnlockShared();
+        }
+        return items;
     }
 
     bool Remove(T item, std::function<bool(T, T)> compareFunction) {
-        if (_isIterating) {
-            log_device(true, __FUNCTION__, "Nao pode modificar a lista enquanto a itera");
-            return false;
-        }
         auto res = false;
         if (Lock()) {
             for (auto it = _list.begin(); it != _list.end(); ++it) {
@@ -93,15 +128,14 @@ public:
                 }
             }
             Unlock();
-            _isIterating = false;
         }
         return res;
     }
 
     auto Size() -> uint32_t {
-        if (Lock()) {
+        if (LockShared()) {
             uint32_t size = _list.size();
-            Unlock();
+            UnlockShared();
             return size;
         }
         return 0;
@@ -115,7 +149,6 @@ public:
     }
 
 private:
-    bool _isIterating = false;
     std::list<T> _list = std::list<T>();
 };
 
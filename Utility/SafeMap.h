@@ -6,7 +6,12 @@
 #define LOCKABLEMAP_H
 
 #include<LockableContainer.h>
+#include <map>
+#include <tuple>
 
+/**
+ * Ordered map behind a single lock. For hot lookups shared between tasks prefer StripedHashMap.
+ */
 template<class TKey, class TValue>
 class SafeMap : public LockableContainer{
 private:
@@ -14,6 +19,10 @@ private:
     std::map<TKey, TValue> _emptyMap{};
 
 public:
+    SafeMap() = default;
+
+    explicit SafeMap(const char *lockName) : LockableContainer(lockName) {}
+
     bool HasKey(TKey key) {
         if (!Lock()) return false;
         auto res = _internalMap.find(key);
@@ -22,17 +31,15 @@ public:
     }
 
     std::tuple<bool, TValue> operator[](TKey key) {
-        TValue value;
-        bool isValid = false;
-        auto hasKey = HasKey(key);
+        TValue value{};
         if (!Lock()) return {false, value};
-        if (hasKey) {
-            value = _internalMap[key];
-            isValid = true;
+        auto it = _internalMap.find(key);
+        bool isValid = it != _internalMap.end();
+        if (isValid) {
+            value = it->second;
         }
         Unlock();
         return {isValid, value};
-
     }
 
     std::map<TKey, TValue> &StartIteration() {
@@ -0,0 +1,331 @@
+//
+// Mapa hash concorrente com travas por faixa (lock striping)
+//
+
+#ifndef STRIPEDHASHMAP_H
+#define STRIPEDHASHMAP_H
+
+#ifdef STM32L1
+
+#include <FreeRTOS.h>
+#include <semphr.h>
+
+#elif defined(ESP_PLATFORM)
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "CrossPlatformUtility.h"
+
+/**
+ * Default hasher of StripedHashMap. Strings of any kind (std::string, std::string_view, const char *)
+ * hash to the same value, which is what allows looking up std::string keys with a std::string_view.
+ */
+struct MapHash {
+    uint32_t operator()(std::string_view value) const {
+        uint32_t hash = 2166136261u; // FNV-1a
+        for (char ch: value) {
+            hash ^= static_cast<uint8_t>(ch);
+            hash *= 16777619u;
+        }
+        return mix(hash);
+    }
+
+    uint32_t operator()(const std::string &value) const {
+        return (*this)(std::string_view(value));
+    }
+
+    uint32_t operator()(const char *value) const {
+        return (*this)(std::string_view(value));
+    }
+
+    template<typename T, typename = std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>>>
+    uint32_t operator()(T value) const {
+        auto raw = static_cast<uint64_t>(value);
+        return mix(static_cast<uint32_t>(raw ^ (raw >> 32)));
+    }
+
+    static uint32_t mix(uint32_t hash) { // Finalizador do murmur3
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6bu;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35u;
+        hash ^= hash >> 16;
+        return hash;
+    }
+};
+
+/**
+ * Fixed-capacity concurrent hash map with open addressing (linear probing) and lock striping.
+ *
+ * The table is split in Stripes independent segments, each with its own mutex, so operations on keys of
+ * different stripes run in parallel on both cores. Lookups accept any key type the hasher and operator==
+ * understand (e.g. std::string_view for std::string keys) without building a temporary key. Values can be
+ * read or changed in place with functors, under the stripe lock, instead of being copied out and back.
+ *
+ * Removals use backward-shift deletion, so there are no tombstones and probes stay short. Each stripe keeps at
+ * least one slot empty, which is what ends the probes and the shifts, so a stripe holds Capacity / Stripes - 1
+ * entries at most.
+ *
+ * @tparam TKey Key type, default constructible.
+ * @tparam TValue Value type, default constructible.
+ * @tparam Capacity Total number of slots, power of two. Keep the load under ~75%.
+ * @tparam Stripes Number of locks/segments, power of two, at most Capacity.
+ * @tparam Hash Hasher returning uint32_t.
+ */
+template<class TKey, class TValue, size_t Capacity = 64, size_t Stripes = 8, class Hash = MapHash>
+class StripedHashMap {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert((Stripes & (Stripes - 1)) == 0 && Stripes <= Capacity, "Stripes must be a power of two <= Capacity");
+    static_assert(Capacity / Stripes >= 2, "Each stripe needs room for one entry plus the empty slot");
+
+public:
+    StripedHashMap() {
+        for (auto &stripe: _stripes) {
+            stripe.mutex = xSemaphoreCreateMutexStatic(&stripe.mutexBuffer);
+        }
+    }
+
+    ~StripedHashMap() {
+        for (auto &stripe: _stripes) {
+            vSemaphoreDelete(stripe.mutex);
+        }
+    }
+
+    StripedHashMap(const StripedHashMap &) = delete;
+
+    StripedHashMap &operator=(const StripedHashMap &) = delete;
+
+    template<class K>
+    bool HasKey(const K &key) {
+        return Read(key, [](const TValue &) {});
+    }
+
+    /**
+     * Copies the value out, kept for code written against SafeMap.
+     */
+    template<class K>
+    std::tuple<bool, TValue> operator[](const K &key) {
+        TValue value{};
+        bool found = TryGet(key, value);
+        return {found, value};
+    }
+
+    template<class K>
+    bool TryGet(const K &key, TValue &value) {
+        return Read(key, [&value](const TValue &stored) { value = stored; });
+    }
+
+    /**
+     * Calls reader(const TValue &) under the stripe lock.
+     * @return False if the key is not in the map.
+     */
+    template<class K, class Reader>
+    bool Read(const K &key, Reader &&reader) {
+        uint32_t hash = _hash(key);
+        Stripe &stripe = stripeOf(hash);
+        if (!lock(stripe)) return false;
+        int32_t index = find(stripe, hash, key);
+        if (index >= 0) {
+            reader(static_cast<const TValue &>(stripe.slots[index].value));
+        }
+        unlock(stripe);
+        return index >= 0;
+    }
+
+    /**
+     * Calls updater(TValue &) under the stripe lock, changing the value in place.
+     * @return False if the key is not in the map.
+     */
+    template<class K, class Updater>
+    bool Update(const K &key, Updater &&updater) {
+        uint32_t hash = _hash(key);
+        Stripe &stripe = stripeOf(hash);
+        if (!lock(stripe)) return false;
+        int32_t index = find(stripe, hash, key);
+        if (index >= 0) {
+            updater(stripe.slots[index].value);
+        }
+        unlock(stripe);
+        return index >= 0;
+    }
+
+    /**
+     * Inserts a default value if the key is missing, then calls updater(TValue &, bool inserted) in place.
+     * @return False if the key is missing and its stripe is full (only the empty slot left).
+     */
+    template<class K, class Updater>
+    bool Upsert(const K &key, Updater &&updater) {
+        uint32_t hash = _hash(key);
+        Stripe &stripe = stripeOf(hash);
+        if (!lock(stripe)) return false;
+        bool inserted = false;
+        int32_t index = findOrInsert(stripe, hash, key, inserted);
+        if (index >= 0) {
+            updater(stripe.slots[index].value, inserted);
+        }
+        unlock(stripe);
+        if (index < 0) {
+            log_device(true, __FUNCTION__, "Sem espaco na faixa do mapa");
+        }
+        return index >= 0;
+    }
+
+    template<class K>
+    bool AddOrUpdate(const K &key, TValue value) {
+        return Upsert(key, [&value](TValue &stored, bool) { stored = std::move(value); });
+    }
+
+    template<class K>
+    bool Remove(const K &key) {
+        uint32_t hash = _hash(key);
+        Stripe &stripe = stripeOf(hash);
+        if (!lock(stripe)) return false;
+        int32_t index = find(stripe, hash, key);
+        if (index >= 0) {
+            erase(stripe, static_cast<uint32_t>(index));
+        }
+        unlock(stripe);
+        return index >= 0;
+    }
+
+    /**
+     * Visits every entry as visitor(const TKey &, TValue &), one stripe lock at a time.
+     * The view is consistent per stripe, not across the whole map.
+     */
+    template<class Visitor>
+    void ForEach(Visitor &&visitor) {
+        for (auto &stripe: _stripes) {
+            if (!lock(stripe)) continue;
+            for (auto &slot: stripe.slots) {
+                if (slot.used) visitor(static_cast<const TKey &>(slot.key), slot.value);
+            }
+            unlock(stripe);
+        }
+    }
+
+    size_t Size() {
+        size_t size = 0;
+        for (auto &stripe: _stripes) {
+            if (!lock(stripe)) continue;
+            size += stripe.count;
+            unlock(stripe);
+        }
+        return size;
+    }
+
+private:
+    static constexpr size_t SlotsPerStripe = Capacity / Stripes;
+    static constexpr uint32_t SlotMask = SlotsPerStripe - 1;
+
+    static constexpr uint32_t log2(size_t value) {
+        return value <= 1 ? 0 : 1 + log2(value / 2);
+    }
+
+    static constexpr uint32_t StripeBits = log2(Stripes);
+
+    struct Slot {
+        bool used = false;
+        uint32_t hash = 0;
+        TKey key{};
+        TValue value{};
+    };
+
+    struct Stripe {
+        Slot slots[SlotsPerStripe];
+        uint32_t count = 0;
+        StaticSemaphore_t mutexBuffer{};
+        SemaphoreHandle_t mutex = nullptr;
+    };
+
+    Stripe &stripeOf(uint32_t hash) {
+        return _stripes[hash & (Stripes - 1)];
+    }
+
+    static uint32_t home(uint32_t hash) {
+        return (hash >> StripeBits) & SlotMask;
+    }
+
+    static bool lock(Stripe &stripe) {
+        if (xSemaphoreTake(stripe.mutex, 1000) == pdPASS) return true;
+        log_device(true, __FUNCTION__, "Falha Obtendo Trava");
+        return false;
+    }
+
+    static void unlock(Stripe &stripe) {
+        xSemaphoreGive(stripe.mutex);
+    }
+
+    template<class K>
+    static int32_t find(Stripe &stripe, uint32_t hash, const K &key) {
+        uint32_t index = home(hash);
+        for (size_t probe = 0; probe < SlotsPerStripe; probe++) {
+            const Slot &slot = stripe.slots[index];
+            if (!slot.used) return -1;
+            if (slot.hash == hash && slot.key == key) return static_cast<int32_t>(index);
+            index = (index + 1) & SlotMask;
+        }
+        return -1;
+    }
+
+    template<class K>
+    static int32_t findOrInsert(Stripe &stripe, uint32_t hash, const K &key, bool &inserted) {
+        uint32_t index = home(hash);
+        for (size_t probe = 0; probe < SlotsPerStripe; probe++) {
+            Slot &slot = stripe.slots[index];
+            if (!slot.used) {
+                // O último slot vazio não é usado: sem ele a busca e a remoção não teriam onde parar
+                if (stripe.count >= SlotsPerStripe - 1) return -1;
+                slot.used = true;
+                slot.hash = hash;
+                slot.key = TKey(key);
+                slot.value = TValue{};
+                stripe.count++;
+                inserted = true;
+                return static_cast<int32_t>(index);
+            }
+            if (slot.hash == hash && slot.key == key) return static_cast<int32_t>(index);
+            index = (index + 1) & SlotMask;
+        }
+        return -1;
+    }
+
+    static void erase(Stripe &stripe, uint32_t hole) {
+        // Remoção com deslocamento para trás: puxa as entradas seguintes cuja posição ideal
+        // não fica entre o buraco e a posição atual, mantendo as sondagens válidas
+        uint32_t index = hole;
+        for (size_t probe = 1; probe < SlotsPerStripe; probe++) {
+            index = (index + 1) & SlotMask;
+            Slot &slot = stripe.slots[index];
+            if (!slot.used) break;
+            uint32_t ideal = home(slot.hash);
+            uint32_t distanceFromIdeal = (index - ideal) & SlotMask;
+            uint32_t distanceFromHole = (index - hole) & SlotMask;
+            if (distanceFromIdeal >= distanceFromHole) {
+                stripe.slots[hole] = std::move(slot);
+                hole = index;
+            }
+        }
+        Slot &freed = stripe.slots[hole];
+        freed.used = false;
+        freed.key = TKey{};
+        freed.value = TValue{};
+        stripe.count--;
+    }
+
+    Hash _hash{};
+    Stripe _stripes[Stripes];
+};
+
+#endif //STRIPEDHASHMAP_H
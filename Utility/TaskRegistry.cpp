@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cstring>
+#include <esp_log.h>
+#include "TaskRegistry.h"
+
+/**
+ * @file TaskRegistry.cpp
+ * @brief Table of the tracked tasks and its sampling.
+ */
+
+#ifdef ESP_PLATFORM
+static portMUX_TYPE registryMux = portMUX_INITIALIZER_UNLOCKED;
+#define REGISTRY_ENTER() portENTER_CRITICAL(&registryMux)
+#define REGISTRY_EXIT() portEXIT_CRITICAL(&registryMux)
+#else
+#define REGISTRY_ENTER() taskENTER_CRITICAL()
+#define REGISTRY_EXIT() taskEXIT_CRITICAL()
+#endif
+
+#if configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY
+#define TASK_REGISTRY_RUN_TIME 1
+#else
+#define TASK_REGISTRY_RUN_TIME 0
+#endif
+
+namespace {
+
+struct Entry {
+    TaskInfo info;
+    uint64_t lastRunTime;
+    bool used;
+    bool stackAlerted;
+    bool cpuAlerted;
+    uint8_t pendingAlerts; /**< Bits de TaskAlert a disparar fora da seção crítica */
+};
+
+Entry entries[TASK_REGISTRY_CAPACITY]; //NOLINT
+uint32_t minFreeStackThreshold = 0;
+uint8_t maxCpuThreshold = 0;
+
+#if TASK_REGISTRY_RUN_TIME
+
+uint64_t lastTotalRunTime = 0;
+
+/**
+ * Updates the entry from the system state. Returns false if the task is gone.
+ */
+bool refresh(Entry &entry, const std::vector<TaskStatus_t> &states, uint64_t totalDelta) {
+    for (const auto &state: states) {
+        // Compara o nome também: o TCB de uma tarefa apagada pode ser reaproveitado
+        if (state.xHandle != entry.info.handle ||
+            strncmp(state.pcTaskName, entry.info.name, sizeof(entry.info.name)) != 0) {
+            continue;
+        }
+        entry.info.stackFreeMin = state.usStackHighWaterMark;
+        entry.info.priority = state.uxCurrentPriority;
+        uint64_t runDelta = static_cast<uint64_t>(state.ulRunTimeCounter) - entry.lastRunTime;
+        entry.lastRunTime = state.ulRunTimeCounter;
+        entry.info.cpuPercent = totalDelta > 0 ? static_cast<uint8_t>(std::min<uint64_t>(runDelta * 100 / totalDelta, 100))
+                                               : 0;
+        return true;
+    }
+    entry.info.alive = false;
+    return false;
+}
+
+#else
+
+bool refresh(Entry &entry) {
+    entry.info.stackFreeMin = uxTaskGetStackHighWaterMark(entry.info.handle);
+    return true;
+}
+
+#endif
+
+void checkThresholds(Entry &entry) {
+    bool lowStack = minFreeStackThreshold > 0 && entry.info.stackFreeMin < minFreeStackThreshold;
+    if (lowStack && !entry.stackAlerted) entry.pendingAlerts |= 1u << static_cast<uint8_t>(TaskAlert::LowStack);
+    entry.stackAlerted = lowStack;
+
+    bool highCpu = maxCpuThreshold > 0 && entry.info.cpuPercent > maxCpuThreshold;
+    if (highCpu && !entry.cpuAlerted) entry.pendingAlerts |= 1u << static_cast<uint8_t>(TaskAlert::HighCpu);
+    entry.cpuAlerted = highCpu;
+}
+
+}
+
+Event<const TaskInfo &, TaskAlert> TaskRegistry::onAlert{};
+TimerHandle TaskRegistry::_sampleTimer{};
+
+void TaskRegistry::add(TaskHandle_t handle, const char *name, uint32_t stackSize, UBaseType_t priority, int core) {
+    if (handle == nullptr) return;
+    bool added = false;
+    REGISTRY_ENTER();
+    for (auto &entry: entries) {
+        if (entry.used) continue;
+        entry = {};
+        entry.used = true;
+        entry.info.handle = handle;
+        strncpy(entry.info.name, name, sizeof(entry.info.name) - 1);
+        entry.info.core = core;
+        entry.info.priority = priority;
+        entry.info.stackSize = stackSize;
+        entry.info.stackFreeMin = stackSize;
+        entry.info.alive = true;
+        added = true;
+        break;
+    }
+    REGISTRY_EXIT();
+    if (!added) {
+        ESP_LOGW("TaskRegistry", "Registro cheio, tarefa \"%s\" nao sera monitorada", name);
+    }
+}
+
+void TaskRegistry::remove(TaskHandle_t handle) {
+    REGISTRY_ENTER();
+    for (auto &entry: entries) {
+        if (entry.used && entry.info.handle == handle) {
+            entry.used = false;
+        }
+    }
+    REGISTRY_EXIT();
+}
+
+void TaskRegistry::sample() {
+#if TASK_REGISTRY_RUN_TIME
+    // Lê o estado de todas as tarefas de uma vez: tarefas apagadas simplesmente não aparecem
+    std::vector<TaskStatus_t> states(uxTaskGetNumberOfTasks() + 4);
+    configRUN_TIME_COUNTER_TYPE totalRunTime = 0;
+    states.resize(uxTaskGetSystemState(states.data(), states.size(), &totalRunTime));
+    uint64_t totalDelta = static_cast<uint64_t>(totalRunTime) - lastTotalRunTime;
+    lastTotalRunTime = totalRunTime;
+#endif
+
+    REGISTRY_ENTER();
+    for (auto &entry: entries) {
+        if (!entry.used || !entry.info.alive) continue;
+#if TASK_REGISTRY_RUN_TIME
+        if (!refresh(entry, states, totalDelta)) continue;
+#else
+        if (!refresh(entry)) continue;
+#endif
+        checkThresholds(entry);
+    }
+    REGISTRY_EXIT();
+
+    for (auto &entry: entries) {
+        REGISTRY_ENTER();
+        TaskInfo info = entry.info;
+        uint8_t pending = entry.used ? entry.pendingAlerts : 0;
+        entry.pendingAlerts = 0;
+        REGISTRY_EXIT();
+
+        if (pending & (1u << static_cast<uint8_t>(TaskAlert::LowStack))) {
+            ESP_LOGW("TaskRegistry", "Tarefa \"%s\" com pouca pilha livre: %lu de %lu", info.name,
+                     (unsigned long) info.stackFreeMin, (unsigned long) info.stackSize);
+            onAlert.trigger(info, TaskAlert::LowStack);
+        }
+        if (pending & (1u << static_cast<uint8_t>(TaskAlert::HighCpu))) {
+            ESP_LOGW("TaskRegistry", "Tarefa \"%s\" usando %u%% da CPU", info.name, info.cpuPercent);
+            onAlert.trigger(info, TaskAlert::HighCpu);
+        }
+    }
+}
+
+bool TaskRegistry::startSampling(uint32_t periodMs) {
+    TimerService::start();
+    TimerService::cancel(_sampleTimer);
+    _sampleTimer = TimerService::schedulePeriodic(periodMs, sample);
+    return _sampleTimer.isValid();
+}
+
+void TaskRegistry::stopSampling() {
+    TimerService::cancel(_sampleTimer);
+}
+
+void TaskRegistry::setAlertThresholds(uint32_t minFreeStack, uint8_t maxCpuPercent) {
+    REGISTRY_ENTER();
+    minFreeStackThreshold = minFreeStack;
+    maxCpuThreshold = maxCpuPercent;
+    REGISTRY_EXIT();
+}
+
+std::vector<TaskInfo> TaskRegistry::snapshot() {
+    std::vector<TaskInfo> result;
+    result.reserve(TASK_REGISTRY_CAPACITY);
+    REGISTRY_ENTER();
+    for (const auto &entry: entries) {
+        if (entry.used) result.push_back(entry.info);
+    }
+    REGISTRY_EXIT();
+    return result;
+}
+
+nlohmann::json TaskRegistry::toJson() {
+    nlohmann::json tasks = nlohmann::json::array();
+    for (const auto &info: snapshot()) {
+        tasks.push_back({
+                                {"name",         info.name},
+                                {"core",         info.core},
+                                {"priority",     info.priority},
+                                {"stackSize",    info.stackSize},
+                                {"stackFreeMin", info.stackFreeMin},
+                                {"cpuPercent",   info.cpuPercent},
+                                {"alive",        info.alive}
+                        });
+    }
+    return tasks;
+}
+
+void TaskRegistry::logStats() {
+    for (const auto &info: snapshot()) {
+        ESP_LOGI("TaskRegistry", "%s: nucleo %d, prioridade %u, pilha livre min %lu de %lu, CPU %u%%%s", info.name,
+                 info.core, (unsigned) info.priority, (unsigned long) info.stackFreeMin,
+                 (unsigned long) info.stackSize, info.cpuPercent, info.alive ? "" : " (encerrada)");
+    }
+}
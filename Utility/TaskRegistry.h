@@ -0,0 +1,104 @@
+#ifndef TASKREGISTRY_H
+#define TASKREGISTRY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#ifdef STM32L1
+#include <FreeRTOS.h>
+#include <task.h>
+#elif defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+#include <nlohmann/json.hpp>
+#include "Event.h"
+#include "TimerService.h"
+
+#ifndef TASK_REGISTRY_CAPACITY
+/**
+ * @brief Tasks tracked by the registry. Tasks created after it is full are not tracked.
+ */
+#define TASK_REGISTRY_CAPACITY 24
+#endif
+
+#ifndef TASK_REGISTRY_SAMPLE_MS
+#define TASK_REGISTRY_SAMPLE_MS 5000
+#endif
+
+/**
+ * @struct TaskInfo
+ * @brief What the registry knows about one task.
+ */
+struct TaskInfo {
+    TaskHandle_t handle;
+    char name[configMAX_TASK_NAME_LEN];
+    int core;
+    UBaseType_t priority;
+    uint32_t stackSize;     /**< Stack given to the task at creation */
+    uint32_t stackFreeMin;  /**< Lowest free stack seen (high-water mark) */
+    uint8_t cpuPercent;     /**< Share of one core used in the last sample window */
+    bool alive;             /**< False once the task was deleted */
+};
+
+/**
+ * @enum TaskAlert
+ * @brief Threshold crossed by a task.
+ */
+enum class TaskAlert : uint8_t {
+    LowStack,
+    HighCpu
+};
+
+/**
+ * @class TaskRegistry
+ * @brief Tracks every task created through Utility::CreateAndProfile and samples its stack and CPU use.
+ *
+ * CPU shares need configGENERATE_RUN_TIME_STATS and configUSE_TRACE_FACILITY; without them only the
+ * stack is sampled, and tasks that are deleted must be removed with remove() first.
+ */
+class TaskRegistry {
+public:
+    TaskRegistry() = delete;
+
+    /**
+     * @brief Raised once when a task crosses a threshold, again only after it recovers.
+     * Runs on the TimerService task.
+     */
+    static Event<const TaskInfo &, TaskAlert> onAlert;
+
+    static void add(TaskHandle_t handle, const char *name, uint32_t stackSize, UBaseType_t priority, int core);
+
+    static void remove(TaskHandle_t handle);
+
+    /**
+     * @brief Samples every task now and raises the alerts.
+     */
+    static void sample();
+
+    /**
+     * @brief Samples periodically on the TimerService. Calling it again changes the period.
+     */
+    static bool startSampling(uint32_t periodMs = TASK_REGISTRY_SAMPLE_MS);
+
+    static void stopSampling();
+
+    /**
+     * @brief Alerts when a task has less than minFreeStack bytes left or uses more than maxCpuPercent of a core.
+     * Zero disables the check.
+     */
+    static void setAlertThresholds(uint32_t minFreeStack, uint8_t maxCpuPercent);
+
+    static std::vector<TaskInfo> snapshot();
+
+    static nlohmann::json toJson();
+
+    static void logStats();
+
+private:
+    static TimerHandle _sampleTimer;
+};
+
+#endif // TASKREGISTRY_H
@@ -0,0 +1,397 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+#include "TimerService.h"
+#include "Utility.h"
+#include "CrossPlatformUtility.h"
+
+/**
+ * @file TimerService.cpp
+ * @brief Hierarchical timer wheel and the task that runs the due callbacks.
+ */
+
+#ifdef ESP_PLATFORM
+static portMUX_TYPE wheelMux = portMUX_INITIALIZER_UNLOCKED;
+#define WHEEL_ENTER() portENTER_CRITICAL(&wheelMux)
+#define WHEEL_EXIT() portEXIT_CRITICAL(&wheelMux)
+#else
+#define WHEEL_ENTER() taskENTER_CRITICAL()
+#define WHEEL_EXIT() taskEXIT_CRITICAL()
+#endif
+
+namespace {
+
+constexpr uint32_t LevelBits = 6;
+constexpr uint32_t SlotCount = 1u << LevelBits;
+constexpr uint32_t SlotMask = SlotCount - 1;
+constexpr uint32_t LevelCount = 4;
+constexpr TickType_t MaxDelay = (1u << (LevelBits * LevelCount)) - 1;
+constexpr uint16_t None = UINT16_MAX;
+
+static_assert(TIMER_SERVICE_CAPACITY < None, "TIMER_SERVICE_CAPACITY must be below 65535");
+
+enum class TimerState : uint8_t {
+    Free,
+    Pending,
+    Firing
+};
+
+struct TimerNode {
+    TimerCallback callback;
+    int64_t dueUs = 0;
+    TickType_t expires = 0;
+    TickType_t period = 0;
+    uint16_t prev = None;
+    uint16_t next = None;
+    uint16_t generation = 0;
+    uint8_t level = 0;
+    uint8_t slot = 0;
+    TimerState state = TimerState::Free;
+    bool cancelled = false;
+};
+
+/**
+ * Timer wheel. Every field is only touched inside WHEEL_ENTER/WHEEL_EXIT.
+ */
+struct Wheel {
+    TimerNode nodes[TIMER_SERVICE_CAPACITY];
+    uint16_t heads[LevelCount][SlotCount];
+    uint64_t occupied[LevelCount] = {};
+    uint16_t freeList = 0;
+    TickType_t current = 0;
+    TickType_t wakeAt = 0;
+    bool idle = true;
+    bool synced = false;
+
+    uint32_t active = 0;
+    uint32_t fired = 0;
+    uint32_t overruns = 0;
+    uint32_t rejected = 0;
+    int32_t maxLateUs = 0;
+    int32_t maxEarlyUs = 0;
+    uint64_t totalJitterUs = 0;
+
+    Wheel() {
+        for (auto &level: heads) {
+            for (auto &head: level) head = None;
+        }
+        for (uint16_t i = 0; i < TIMER_SERVICE_CAPACITY; i++) {
+            nodes[i].next = i + 1 < TIMER_SERVICE_CAPACITY ? i + 1 : None;
+        }
+    }
+
+    /**
+     * Starts counting from the current tick on first use, timers may be scheduled before the task runs.
+     */
+    void sync(TickType_t now) {
+        if (!synced) {
+            current = now;
+            synced = true;
+        }
+    }
+
+    uint16_t allocate() {
+        uint16_t index = freeList;
+        if (index != None) {
+            freeList = nodes[index].next;
+            active++;
+        }
+        return index;
+    }
+
+    void release(uint16_t index) {
+        TimerNode &node = nodes[index];
+        node.callback.reset();
+        node.state = TimerState::Free;
+        node.generation++;
+        node.next = freeList;
+        freeList = index;
+        active--;
+    }
+
+    void insert(uint16_t index) {
+        TimerNode &node = nodes[index];
+        TickType_t delta = node.expires - current;
+        uint8_t level = 0;
+        while (level < LevelCount - 1 && delta >= (1u << (LevelBits * (level + 1)))) level++;
+        uint8_t slot = (node.expires >> (LevelBits * level)) & SlotMask;
+
+        node.level = level;
+        node.slot = slot;
+        node.state = TimerState::Pending;
+        node.prev = None;
+        node.next = heads[level][slot];
+        if (node.next != None) nodes[node.next].prev = index;
+        heads[level][slot] = index;
+        occupied[level] |= 1ull << slot;
+    }
+
+    void unlink(uint16_t index) {
+        TimerNode &node = nodes[index];
+        if (node.prev != None) {
+            nodes[node.prev].next = node.next;
+        } else {
+            heads[node.level][node.slot] = node.next;
+        }
+        if (node.next != None) nodes[node.next].prev = node.prev;
+        if (heads[node.level][node.slot] == None) occupied[node.level] &= ~(1ull << node.slot);
+    }
+
+    uint16_t detach(uint32_t level, uint32_t slot) {
+        uint16_t first = heads[level][slot];
+        heads[level][slot] = None;
+        occupied[level] &= ~(1ull << slot);
+        return first;
+    }
+
+    /**
+     * Distance (1..64) from slot `from` to the next occupied slot of the level, wrapping around.
+     */
+    static uint32_t distance(uint64_t bitmap, uint32_t from) {
+        uint32_t shift = (from + 1) & SlotMask;
+        uint64_t rotated = shift == 0 ? bitmap : (bitmap >> shift) | (bitmap << (SlotCount - shift));
+        return __builtin_ctzll(rotated) + 1;
+    }
+
+    /**
+     * Next tick that fires a timer or cascades an occupied slot.
+     */
+    bool nextEvent(TickType_t &tick) const {
+        bool found = false;
+        for (uint32_t level = 0; level < LevelCount; level++) {
+            if (occupied[level] == 0) continue;
+            uint32_t shift = LevelBits * level;
+            TickType_t block = current >> shift;
+            TickType_t candidate = (block + distance(occupied[level], block & SlotMask)) << shift;
+            if (!found || static_cast<int32_t>(candidate - tick) < 0) {
+                tick = candidate;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    /**
+     * Moves the wheel to `tick` and appends the timers due on it to the firing list.
+     */
+    void advance(TickType_t tick, uint16_t &firstFiring, uint16_t &lastFiring) {
+        current = tick;
+        // Níveis mais altos primeiro, o que desce de um nível pode descer de novo no mesmo tick
+        for (uint32_t level = LevelCount - 1; level > 0; level--) {
+            uint32_t shift = LevelBits * level;
+            if ((tick & ((1u << shift) - 1)) != 0) continue;
+            uint16_t index = detach(level, (tick >> shift) & SlotMask);
+            while (index != None) {
+                uint16_t next = nodes[index].next;
+                insert(index);
+                index = next;
+            }
+        }
+
+        uint16_t index = detach(0, tick & SlotMask);
+        while (index != None) {
+            uint16_t next = nodes[index].next;
+            nodes[index].state = TimerState::Firing;
+            nodes[index].next = None;
+            if (lastFiring == None) {
+                firstFiring = index;
+            } else {
+                nodes[lastFiring].next = index;
+            }
+            lastFiring = index;
+            index = next;
+        }
+    }
+
+    bool matches(const TimerHandle &handle) const {
+        return handle.index < TIMER_SERVICE_CAPACITY && nodes[handle.index].generation == handle.generation &&
+               nodes[handle.index].state != TimerState::Free;
+    }
+
+    void recordLateness(int64_t lateUs) {
+        fired++;
+        if (lateUs > maxLateUs) maxLateUs = static_cast<int32_t>(lateUs);
+        if (-lateUs > maxEarlyUs) maxEarlyUs = static_cast<int32_t>(-lateUs);
+        totalJitterUs += lateUs < 0 ? -lateUs : lateUs;
+    }
+};
+
+Wheel wheel; //NOLINT
+
+TickType_t msToTicksCeil(uint32_t ms) {
+    TickType_t ticks = (ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+    if (ticks == 0) ticks = 1;
+    return ticks > MaxDelay ? MaxDelay : ticks;
+}
+
+}
+
+TaskHandle_t TimerService::_task = nullptr;
+
+bool TimerService::start(uint32_t stack, UBaseType_t priority, int core) {
+    if (_task != nullptr) {
+        return true;
+    }
+    _task = Utility::CreateAndProfile("TimerServiceTask", serviceTask, stack, priority, core, nullptr);
+    return _task != nullptr;
+}
+
+TimerHandle TimerService::scheduleOnce(uint32_t delayMs, TimerCallback callback) {
+    return schedule(msToTicksCeil(delayMs), 0, std::move(callback));
+}
+
+TimerHandle TimerService::schedulePeriodic(uint32_t periodMs, TimerCallback callback) {
+    TickType_t period = pdMS_TO_TICKS(periodMs);
+    if (period == 0) period = 1;
+    if (period > MaxDelay) period = MaxDelay;
+    return schedule(period, period, std::move(callback));
+}
+
+TimerHandle TimerService::schedule(TickType_t delay, TickType_t period, TimerCallback &&callback) {
+    TimerHandle handle{};
+    int64_t dueUs = esp_timer_get_time() + static_cast<int64_t>(delay) * portTICK_PERIOD_MS * 1000;
+
+    WHEEL_ENTER();
+    wheel.sync(xTaskGetTickCount());
+    uint16_t index = wheel.allocate();
+    bool wake = false;
+    if (index != None) {
+        TimerNode &node = wheel.nodes[index];
+        node.callback = std::move(callback);
+        node.expires = xTaskGetTickCount() + delay;
+        node.period = period;
+        node.dueUs = dueUs;
+        node.cancelled = false;
+        wheel.insert(index);
+        handle = {index, node.generation};
+        wake = wheel.idle || static_cast<int32_t>(node.expires - wheel.wakeAt) < 0;
+    } else {
+        wheel.rejected++;
+    }
+    WHEEL_EXIT();
+
+    if (index == None) {
+        log_device(true, __FUNCTION__, "Sem timers livres");
+    } else if (wake && _task != nullptr) {
+        xTaskNotifyGive(_task);
+    }
+    return handle;
+}
+
+bool TimerService::cancel(TimerHandle &handle) {
+    bool cancelled = false;
+    WHEEL_ENTER();
+    if (wheel.matches(handle)) {
+        TimerNode &node = wheel.nodes[handle.index];
+        if (node.state == TimerState::Pending) {
+            wheel.unlink(handle.index);
+            wheel.release(handle.index);
+            cancelled = true;
+        } else if (!node.cancelled) {
+            // Em execução: a tarefa do serviço libera ao terminar o callback
+            node.cancelled = true;
+            cancelled = true;
+        }
+    }
+    WHEEL_EXIT();
+    handle = {};
+    return cancelled;
+}
+
+bool TimerService::isActive(const TimerHandle &handle) {
+    WHEEL_ENTER();
+    bool active = wheel.matches(handle) && !wheel.nodes[handle.index].cancelled;
+    WHEEL_EXIT();
+    return active;
+}
+
+TimerStats TimerService::getStats() {
+    WHEEL_ENTER();
+    TimerStats stats{
+            wheel.active,
+            wheel.fired,
+            wheel.overruns,
+            wheel.rejected,
+            wheel.maxLateUs,
+            wheel.maxEarlyUs,
+            static_cast<uint32_t>(wheel.fired > 0 ? wheel.totalJitterUs / wheel.fired : 0)
+    };
+    WHEEL_EXIT();
+    return stats;
+}
+
+void TimerService::logStats() {
+    auto stats = getStats();
+    ESP_LOGI("TimerService", "ativos %lu, disparos %lu, atrasos %lu, recusados %lu, jitter medio %lu us "
+                             "(atraso max %ld us, adiantado max %ld us)",
+             (unsigned long) stats.active, (unsigned long) stats.fired, (unsigned long) stats.overruns,
+             (unsigned long) stats.rejected, (unsigned long) stats.avgJitterUs, (long) stats.maxLateUs,
+             (long) stats.maxEarlyUs);
+}
+
+void TimerService::serviceTask(void *arg __unused) {
+    for (;;) {
+        uint16_t firing = None;
+        uint16_t lastFiring = None;
+        TickType_t sleep = portMAX_DELAY;
+
+        WHEEL_ENTER();
+        TickType_t now = xTaskGetTickCount();
+        wheel.sync(now);
+        TickType_t next;
+        while (wheel.nextEvent(next) && static_cast<int32_t>(next - now) <= 0) {
+            wheel.advance(next, firing, lastFiring);
+        }
+        // Nada mais até `now`, os slots pulados estão vazios
+        wheel.current = now;
+        if (firing != None) {
+            wheel.idle = false;
+            wheel.wakeAt = now;
+        } else if (wheel.nextEvent(next)) {
+            wheel.idle = false;
+            wheel.wakeAt = next;
+            sleep = next - now;
+        } else {
+            wheel.idle = true;
+        }
+        WHEEL_EXIT();
+
+        if (firing == None) {
+            ulTaskNotifyTake(pdTRUE, sleep);
+            continue;
+        }
+
+        while (firing != None) {
+            TimerNode &node = wheel.nodes[firing];
+            uint16_t nextFiring = node.next;
+            // Um callback anterior do mesmo lote, ou outra tarefa, pode ter cancelado este depois do advance()
+            WHEEL_ENTER();
+            bool cancelled = node.cancelled;
+            WHEEL_EXIT();
+            int64_t lateUs = esp_timer_get_time() - node.dueUs;
+            if (!cancelled) {
+                node.callback();
+            }
+
+            WHEEL_ENTER();
+            if (!cancelled) {
+                wheel.recordLateness(lateUs);
+            }
+            if (node.period != 0 && !node.cancelled) {
+                node.expires += node.period;
+                node.dueUs += static_cast<int64_t>(node.period) * portTICK_PERIOD_MS * 1000;
+                // Mantém a fase: períodos perdidos são pulados, não executados em rajada
+                while (static_cast<int32_t>(node.expires - wheel.current) <= 0) {
+                    node.expires += node.period;
+                    node.dueUs += static_cast<int64_t>(node.period) * portTICK_PERIOD_MS * 1000;
+                    wheel.overruns++;
+                }
+                wheel.insert(firing);
+            } else {
+                wheel.release(firing);
+            }
+            WHEEL_EXIT();
+
+            firing = nextFiring;
+        }
+    }
+}
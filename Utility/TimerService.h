@@ -0,0 +1,118 @@
+#ifndef TIMERSERVICE_H
+#define TIMERSERVICE_H
+
+#include <cstdint>
+#include <cstddef>
+#include "Delegate.h"
+
+#ifdef STM32L1
+#include <FreeRTOS.h>
+#include <task.h>
+#elif defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+#ifndef TIMER_SERVICE_CAPACITY
+/**
+ * @brief Timers that can be pending at the same time. Preallocated, at most 65534.
+ */
+#define TIMER_SERVICE_CAPACITY 64
+#endif
+
+#ifndef TIMER_SERVICE_STACK
+#define TIMER_SERVICE_STACK 4096
+#endif
+
+#ifndef TIMER_SERVICE_PRIORITY
+#define TIMER_SERVICE_PRIORITY (configMAX_PRIORITIES - 2)
+#endif
+
+/**
+ * @brief Callback of a timer. Stored inline, so scheduling never allocates.
+ */
+using TimerCallback = Delegate<void()>;
+
+/**
+ * @struct TimerHandle
+ * @brief Identifies a scheduled timer. Stays safe to use after the timer fired or was cancelled.
+ */
+struct TimerHandle {
+    uint16_t index = UINT16_MAX;
+    uint16_t generation = 0;
+
+    [[nodiscard]] bool isValid() const {
+        return index != UINT16_MAX;
+    }
+};
+
+/**
+ * @struct TimerStats
+ * @brief Counters of the timer service. Lateness is measured against the requested due time.
+ */
+struct TimerStats {
+    uint32_t active;      /**< Timers pending right now */
+    uint32_t fired;       /**< Callbacks run */
+    uint32_t overruns;    /**< Periods skipped because a periodic timer ran late */
+    uint32_t rejected;    /**< Schedule calls refused because every timer was in use */
+    int32_t maxLateUs;    /**< Latest callback */
+    int32_t maxEarlyUs;   /**< Earliest callback (tick rounding can fire up to one tick early) */
+    uint32_t avgJitterUs; /**< Mean absolute lateness */
+};
+
+/**
+ * @class TimerService
+ * @brief One-shot and periodic callbacks on a hierarchical timer wheel, run by a single task.
+ *
+ * Four levels of 64 slots give one-tick resolution for delays up to 2^24 ticks. Scheduling and
+ * cancelling are O(1) and never allocate. The task sleeps until the next slot that holds a timer,
+ * so nothing runs while no timer is due. Callbacks run on the service task one after the other
+ * and must not block; hand longer work to another task.
+ */
+class TimerService {
+public:
+    TimerService() = delete;
+
+    /**
+     * @brief Creates the service task. Calling it again has no effect.
+     * @return True if the task is running.
+     */
+    static bool start(uint32_t stack = TIMER_SERVICE_STACK, UBaseType_t priority = TIMER_SERVICE_PRIORITY,
+                      int core = 1);
+
+    /**
+     * @brief Runs the callback once after delayMs.
+     * @return Invalid handle if every timer is in use.
+     */
+    static TimerHandle scheduleOnce(uint32_t delayMs, TimerCallback callback);
+
+    /**
+     * @brief Runs the callback every periodMs, keeping the phase if a run is late.
+     * @return Invalid handle if every timer is in use.
+     */
+    static TimerHandle schedulePeriodic(uint32_t periodMs, TimerCallback callback);
+
+    /**
+     * @brief Stops the timer and invalidates the handle. Safe to call from its own callback.
+     *
+     * A timer already taken for the current round but not run yet (cancelled by an earlier callback of the same
+     * round, or by another task) does not run. Only a callback that is running at the moment finishes.
+     * @return False if the timer had already finished.
+     */
+    static bool cancel(TimerHandle &handle);
+
+    static bool isActive(const TimerHandle &handle);
+
+    static TimerStats getStats();
+
+    static void logStats();
+
+private:
+    static TimerHandle schedule(TickType_t delay, TickType_t period, TimerCallback &&callback);
+
+    static void serviceTask(void *arg);
+
+    static TaskHandle_t _task;
+};
+
+#endif // TIMERSERVICE_H
@@ -0,0 +1,52 @@
+#ifndef TOKENBUCKET_H
+#define TOKENBUCKET_H
+
+#include <cstdint>
+
+/**
+ * @class TokenBucket
+ * @brief Token bucket state: how much of a rate budget is left.
+ *
+ * The rate and burst are passed on every call, so whoever enforces a limit keeps its configuration in one place
+ * and the bucket only keeps the level, in thousandths of a token. A new bucket starts full.
+ * Not synchronized: the caller serializes access.
+ */
+class TokenBucket {
+public:
+    /**
+     * @brief Refills at ratePerSecond up to burst tokens and takes the tokens if there are enough.
+     * @param nowUs Current time in µs (Metrics::now()).
+     * @return False, without taking anything, if there are not enough tokens. A zero rate never limits.
+     */
+    bool tryTake(uint32_t tokens, uint32_t ratePerSecond, uint32_t burst, int64_t nowUs) {
+        if (ratePerSecond == 0) return true;
+        uint64_t capacity = static_cast<uint64_t>(burst) * 1000;
+        if (!_started) {
+            _started = true;
+            _level = capacity;
+        } else if (nowUs > _last) {
+            uint64_t refill = static_cast<uint64_t>(nowUs - _last) * ratePerSecond / 1000;
+            _level = _level + refill > capacity ? capacity : _level + refill;
+        }
+        _last = nowUs;
+
+        uint64_t needed = static_cast<uint64_t>(tokens) * 1000;
+        if (_level < needed) return false;
+        _level -= needed;
+        return true;
+    }
+
+    /**
+     * @brief Fills the bucket again on the next call.
+     */
+    void reset() {
+        _started = false;
+    }
+
+private:
+    int64_t _last = 0;
+    uint64_t _level = 0;
+    bool _started = false;
+};
+
+#endif // TOKENBUCKET_H
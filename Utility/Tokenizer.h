@@ -0,0 +1,148 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @enum TokenizerMode
+ * @brief How delimiters separate tokens.
+ */
+enum class TokenizerMode : uint8_t {
+    Fields, /**< Every delimiter ends a field, empty fields are kept and spaces around fields are trimmed */
+    Words   /**< Runs of the delimiter and whitespace separate words, empty words are skipped */
+};
+
+/**
+ * @class Tokenizer
+ * @brief Splits a command line into std::string_view tokens over the original buffer, without allocating.
+ *
+ * - A token starting with '"' runs to the matching '"', delimiters inside it are kept. The quotes are not
+ *   part of the token and anything after the closing quote, up to the next delimiter, is dropped.
+ * - A backslash escapes the next character anywhere. Tokens keep the backslashes; use decode() when
+ *   building the final string, it only does extra work if the token has one.
+ * - If the line starts with '{' the rest of the line is a single token (JSON arguments).
+ *
+ * The source buffer must outlive the tokens.
+ */
+class Tokenizer {
+public:
+    Tokenizer(std::string_view source, char delimiter, TokenizerMode mode = TokenizerMode::Fields)
+            : _source(source), _delimiter(delimiter), _mode(mode) {
+        if (!_source.empty() && _source.front() == '{') {
+            _json = true;
+        }
+    }
+
+    /**
+     * @brief Reads the next token.
+     * @return False when there are no more tokens.
+     */
+    bool next(std::string_view &token) {
+        if (_json) {
+            _json = false;
+            token = _source.substr(0, _source.find('\n'));
+            _position = _source.size();
+            return true;
+        }
+
+        if (_mode == TokenizerMode::Words) {
+            while (_position < _source.size() && isSeparator(_source[_position])) _position++;
+        }
+        if (_position >= _source.size()) return false;
+
+        size_t start = _position;
+        while (start < _source.size() && _source[start] == ' ') start++;
+
+        if (start < _source.size() && _source[start] == '"') {
+            size_t end = findClosingQuote(start + 1);
+            token = _source.substr(start + 1, end - start - 1);
+            _position = end < _source.size() ? end + 1 : end;
+            skipToDelimiter();
+            return true;
+        }
+
+        size_t end = start;
+        while (end < _source.size() && !isSeparator(_source[end])) {
+            end += _source[end] == '\\' && end + 1 < _source.size() ? 2 : 1;
+        }
+        _position = end;
+        skipToDelimiter();
+
+        // Mesma regra do antigo Utility::trim: só espaços
+        while (end > start && _source[end - 1] == ' ') end--;
+        token = _source.substr(start, end - start);
+        return true;
+    }
+
+    /**
+     * @brief Number of tokens left, without consuming them.
+     */
+    size_t count() const {
+        Tokenizer copy = *this;
+        std::string_view token;
+        size_t total = 0;
+        while (copy.next(token)) total++;
+        return total;
+    }
+
+    /**
+     * @brief True if the token has escapes that decode() would remove.
+     */
+    static bool needsDecoding(std::string_view token) {
+        return token.find('\\') != std::string_view::npos;
+    }
+
+    /**
+     * @brief Removes the escapes of a token, writing at most capacity bytes.
+     * @return Length of the decoded token (may be larger than capacity if it was truncated).
+     */
+    static size_t decode(std::string_view token, char *output, size_t capacity) {
+        size_t length = 0;
+        for (size_t i = 0; i < token.size(); i++) {
+            if (token[i] == '\\' && i + 1 < token.size()) i++;
+            if (length < capacity) output[length] = token[i];
+            length++;
+        }
+        return length;
+    }
+
+    /**
+     * @brief Copies the token into a std::string, removing its escapes.
+     */
+    static std::string decode(std::string_view token) {
+        if (!needsDecoding(token)) return std::string(token);
+        std::string result(token.size(), '\0');
+        result.resize(decode(token, result.data(), result.size()));
+        return result;
+    }
+
+private:
+    bool isSeparator(char ch) const {
+        if (ch == _delimiter) return true;
+        return _mode == TokenizerMode::Words && (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n');
+    }
+
+    size_t findClosingQuote(size_t position) const {
+        while (position < _source.size() && _source[position] != '"') {
+            position += _source[position] == '\\' && position + 1 < _source.size() ? 2 : 1;
+        }
+        return position;
+    }
+
+    void skipToDelimiter() {
+        while (_position < _source.size() && !isSeparator(_source[_position])) _position++;
+        // Em Fields o delimitador final não abre um campo vazio, como no std::getline
+        if (_mode == TokenizerMode::Fields && _position < _source.size()) _position++;
+    }
+
+    std::string_view _source;
+    size_t _position = 0;
+    char _delimiter;
+    TokenizerMode _mode;
+    bool _json = false;
+};
+
+#endif // TOKENIZER_H
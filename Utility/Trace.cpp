@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include "Trace.h"
+#include "TaskRegistry.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+#endif
+
+/**
+ * @file Trace.cpp
+ * @brief Trace ring and its Chrome Trace Event export.
+ */
+
+static_assert((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0, "TRACE_BUFFER_SIZE must be a power of two");
+
+namespace {
+
+/**
+ * Slot of the ring. sequence is 0 while the event is being written and index + 1 when it is complete,
+ * so a reader can tell a torn copy apart (seqlock).
+ */
+struct Slot {
+    std::atomic<uint32_t> sequence{0};
+    TraceEvent event{};
+};
+
+Slot slots[TRACE_BUFFER_SIZE]; //NOLINT
+std::atomic<uint32_t> writeIndex{0};
+std::atomic<uint32_t> flowIds{0};
+std::atomic<bool> enabled{TRACE_ENABLED != 0};
+
+int currentCore() {
+#ifdef ESP_PLATFORM
+    return xPortGetCoreID();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Appends text to the line escaping what JSON needs. Returns false if it did not fit.
+ */
+bool appendEscaped(char *line, size_t capacity, size_t &length, const char *text) {
+    for (; *text != '\0'; text++) {
+        char ch = *text;
+        bool escape = ch == '"' || ch == '\\';
+        if (length + (escape ? 2 : 1) >= capacity) return false;
+        if (escape) line[length++] = '\\';
+        line[length++] = static_cast<unsigned char>(ch) < 0x20 ? ' ' : ch;
+    }
+    line[length] = '\0';
+    return true;
+}
+
+bool appendFormat(char *line, size_t capacity, size_t &length, const char *format, ...)
+__attribute__((format(printf, 4, 5)));
+
+bool appendFormat(char *line, size_t capacity, size_t &length, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(line + length, capacity - length, format, args);
+    va_end(args);
+    if (written < 0 || static_cast<size_t>(written) >= capacity - length) return false;
+    length += written;
+    return true;
+}
+
+uint32_t threadId(TaskHandle_t task) {
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(task));
+}
+
+}
+
+int64_t Trace::now() {
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time();
+#else
+    return static_cast<int64_t>(xTaskGetTickCount()) * portTICK_PERIOD_MS * 1000;
+#endif
+}
+
+void Trace::record(TracePhase phase, const char *name, const char *category, int64_t timestamp, uint32_t duration,
+                   uint32_t id) {
+    if (!enabled.load(std::memory_order_relaxed)) return;
+
+    uint32_t index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = slots[index & (TRACE_BUFFER_SIZE - 1)];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event = {name, category, timestamp, duration, id, xTaskGetCurrentTaskHandle(), phase,
+                  static_cast<uint8_t>(currentCore())};
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+uint32_t Trace::newFlowId() {
+    return flowIds.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+void Trace::setEnabled(bool value) {
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+bool Trace::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void Trace::clear() {
+    for (auto &slot: slots) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::vector<TraceEvent> Trace::snapshot() {
+    std::vector<TraceEvent> events;
+    events.reserve(TRACE_BUFFER_SIZE);
+    for (auto &slot: slots) {
+        uint32_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before == 0) continue;
+        TraceEvent event = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) continue; // Sobrescrito durante a cópia
+        events.push_back(event);
+    }
+    std::sort(events.begin(), events.end(), [](const TraceEvent &a, const TraceEvent &b) {
+        return a.timestamp < b.timestamp;
+    });
+    return events;
+}
+
+void Trace::writeChromeJson(const Delegate<void(std::string_view)> &sink) {
+    auto events = snapshot();
+    char line[192];
+    bool first = true;
+    sink("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    // Nomes das tarefas que aparecem no trace
+    for (const auto &task: TaskRegistry::snapshot()) {
+        bool seen = std::any_of(events.begin(), events.end(), [&task](const TraceEvent &event) {
+            return event.task == task.handle;
+        });
+        if (!seen) continue;
+        size_t length = 0;
+        bool fits = appendFormat(line, sizeof(line), length,
+                                 "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%lu,\"args\":{\"name\":\"",
+                                 first ? "" : ",", (unsigned long) threadId(task.handle)) &&
+                    appendEscaped(line, sizeof(line), length, task.name) &&
+                    appendFormat(line, sizeof(line), length, "\"}}");
+        if (fits) {
+            sink(std::string_view(line, length));
+            first = false;
+        }
+    }
+
+    for (const auto &event: events) {
+        size_t length = 0;
+        bool fits = appendFormat(line, sizeof(line), length, "%s{\"name\":\"", first ? "" : ",") &&
+                    appendEscaped(line, sizeof(line), length, event.name) &&
+                    appendFormat(line, sizeof(line), length, "\",\"cat\":\"") &&
+                    appendEscaped(line, sizeof(line), length, event.category) &&
+                    appendFormat(line, sizeof(line), length,
+                                 "\",\"ph\":\"%c\",\"ts\":%lld,\"pid\":0,\"tid\":%lu,\"args\":{\"core\":%u}",
+                                 static_cast<char>(event.phase), (long long) event.timestamp,
+                                 (unsigned long) threadId(event.task), event.core);
+        switch (event.phase) {
+            case TracePhase::Complete:
+                fits = fits && appendFormat(line, sizeof(line), length, ",\"dur\":%lu", (unsigned long) event.duration);
+                break;
+            case TracePhase::Instant:
+                fits = fits && appendFormat(line, sizeof(line), length, ",\"s\":\"t\"");
+                break;
+            case TracePhase::FlowStart:
+                fits = fits && appendFormat(line, sizeof(line), length, ",\"id\":%lu", (unsigned long) event.id);
+                break;
+            case TracePhase::FlowEnd:
+                // bp:e liga o fim do fluxo ao span que o contém
+                fits = fits && appendFormat(line, sizeof(line), length, ",\"id\":%lu,\"bp\":\"e\"",
+                                            (unsigned long) event.id);
+                break;
+        }
+        fits = fits && appendFormat(line, sizeof(line), length, "}");
+        if (fits) {
+            sink(std::string_view(line, length));
+            first = false;
+        }
+    }
+    sink("]}");
+}
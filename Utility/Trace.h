@@ -0,0 +1,142 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#ifdef STM32L1
+#include <FreeRTOS.h>
+#include <task.h>
+#elif defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+#include "Delegate.h"
+
+#ifndef TRACE_ENABLED
+/**
+ * @brief With 0 spans and flows compile to nothing.
+ */
+#define TRACE_ENABLED 1
+#endif
+
+#ifndef TRACE_BUFFER_SIZE
+/**
+ * @brief Events kept by the trace ring; the oldest are overwritten. Must be a power of two.
+ */
+#define TRACE_BUFFER_SIZE 256
+#endif
+
+/**
+ * @enum TracePhase
+ * @brief Kind of a trace event, with the Chrome Trace Event phase letters.
+ */
+enum class TracePhase : char {
+    Complete = 'X',  /**< A span with start and duration */
+    Instant = 'i',   /**< A point in time */
+    FlowStart = 's', /**< Producer side of a flow, linked by id */
+    FlowEnd = 'f'    /**< Consumer side of a flow, linked by id */
+};
+
+/**
+ * @struct TraceEvent
+ * @brief One entry of the trace ring. Names must be static strings.
+ */
+struct TraceEvent {
+    const char *name;
+    const char *category;
+    int64_t timestamp;  /**< µs since boot */
+    uint32_t duration;  /**< µs, Complete events only */
+    uint32_t id;        /**< Flow id, flow events only */
+    TaskHandle_t task;
+    TracePhase phase;
+    uint8_t core;
+};
+
+/**
+ * @class Trace
+ * @brief Lock-free ring of trace events that can be exported as Chrome Trace Event JSON
+ * (open with chrome://tracing or Perfetto).
+ *
+ * Recording takes a timestamp and copies one TraceEvent, from any task or core. To follow work across
+ * tasks, the producer calls flowStart() and the consumer flowEnd() with the same newFlowId(), each inside
+ * a TraceSpan.
+ */
+class Trace {
+public:
+    Trace() = delete;
+
+    static void record(TracePhase phase, const char *name, const char *category, int64_t timestamp,
+                       uint32_t duration = 0, uint32_t id = 0);
+
+    static int64_t now();
+
+    static uint32_t newFlowId();
+
+    static void flowStart(const char *name, uint32_t id) {
+        record(TracePhase::FlowStart, name, "flow", now(), 0, id);
+    }
+
+    static void flowEnd(const char *name, uint32_t id) {
+        record(TracePhase::FlowEnd, name, "flow", now(), 0, id);
+    }
+
+    static void instant(const char *name, const char *category = "app") {
+        record(TracePhase::Instant, name, category, now());
+    }
+
+    /**
+     * @brief Pauses or resumes the recording (enabled by default).
+     */
+    static void setEnabled(bool enabled);
+
+    static bool isEnabled();
+
+    static void clear();
+
+    /**
+     * @brief Copy of the events in the ring, oldest first.
+     */
+    static std::vector<TraceEvent> snapshot();
+
+    /**
+     * @brief Writes the ring as Chrome Trace Event JSON, one small chunk at a time.
+     * Task names come from the TaskRegistry.
+     */
+    static void writeChromeJson(const Delegate<void(std::string_view)> &sink);
+};
+
+/**
+ * @class TraceSpan
+ * @brief Records a Complete event covering its own lifetime.
+ */
+class TraceSpan {
+public:
+#if TRACE_ENABLED
+    explicit TraceSpan(const char *name, const char *category = "app")
+            : _name(name), _category(category), _start(Trace::now()) {}
+
+    ~TraceSpan() {
+        int64_t end = Trace::now();
+        Trace::record(TracePhase::Complete, _name, _category, _start, static_cast<uint32_t>(end - _start));
+    }
+#else
+    explicit TraceSpan(const char *, const char * = "app") {}
+#endif
+
+    TraceSpan(const TraceSpan &) = delete;
+
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+#if TRACE_ENABLED
+private:
+    const char *_name;
+    const char *_category;
+    int64_t _start;
+#endif
+};
+
+#endif // TRACE_H
@@ -9,24 +9,19 @@
 #include <esp_log.h>
 #include "driver/gpio.h"
 #include "Utility.h"
+#include "Tokenizer.h"
+#include "TaskRegistry.h"
 
 
-//#define PROFILE_STACK
 
 auto Utility::split(const std::string &source, char delimiter) -> std::vector<std::string> {
+    Tokenizer tokenizer(source, delimiter);
     std::vector<std::string> strings;
-    std::istringstream iss(source);
-    std::string s;
-
-    if (iss.peek() == '{') {
-        std::string json;
-        std::getline(iss, json);
-        strings.push_back(json);
-        return strings;
-    }
+    strings.reserve(tokenizer.count());
 
-    while (std::getline(iss, s, delimiter)) {
-        strings.push_back(trim(s));
+    std::string_view token;
+    while (tokenizer.next(token)) {
+        strings.push_back(Tokenizer::decode(token));
     }
 
     return strings;
@@ -38,13 +33,11 @@ auto Utility::StringToByteArray(const std::string &input, uint8_t *output) -> ui
 }
 
 std::list<uint8_t> Utility::StringToByteList(const std::string &input) {
-    unsigned char bytes[input.length()];
-    std::list<uint8_t> list;
-    auto size = StringToByteArray(input, bytes);
-    for (int i = 0; i < size; ++i) {
-        list.push_back(bytes[i]);
-    }
-    return list;
+    return {input.begin(), input.end()};
+}
+
+ByteBuffer Utility::StringToByteBuffer(std::string_view input) {
+    return ByteBuffer(input);
 }
 
 auto Utility::CreateAndProfile(const char *taskName, TaskFunction_t function, const uint32_t stack,
@@ -58,15 +51,9 @@ auto Utility::CreateAndProfile(const char *taskName, TaskFunction_t function, co
         ESP_LOGE(__FUNCTION__, "Falha ao criar a tarefa \"%s\"", taskName);
     } else {
         ESP_LOGI(__FUNCTION__, "Tarefa \"%s\" criada com sucesso", taskName);
+        TaskRegistry::add(handle, taskName, stack, priority, core);
     }
 
-#ifdef PROFILE_STACK
-    vTaskDelay(5);
-    auto TaskStackSize = uxTaskGetStackHighWaterMark(handle);
-    ESP_LOGI(__FUNCTION__, "%s stack: %d\n", taskName, TaskStackSize);
-    vTaskDelay(5);
-#endif
-
     return handle;
 }
 
@@ -15,11 +15,17 @@
 #include "esp_log.h"
 #include "sstream"
 #include <list>
+#include <string_view>
+#include "ByteBuffer.h"
+#include "Convert.h"
 
 class Utility {
 
 
 public:
+    /**
+     * Splits with Tokenizer rules (quotes, escapes, JSON passthrough). Prefer Tokenizer directly to avoid the copies.
+     */
     static auto split(const std::string &source, char delimiter) -> std::vector<std::string>;
 
     static auto CreateAndProfile(const char *taskName, TaskFunction_t function, uint32_t stack,
@@ -40,16 +46,15 @@ public:
 
     static uint32_t ReadOutput(gpio_num_t gpio);
 
+    /**
+     * Converts with Convert::fromString. Returns a value-initialized T if the text is not valid.
+     */
     template<typename T>
-    static auto GetConvertedFromString(const std::string &str) -> T {
-        T out;
-        if (str.empty()) {
-            ESP_LOGE(__FUNCTION__, "String vazia");
+    static auto GetConvertedFromString(std::string_view str) -> T {
+        T out{};
+        if (Convert::fromString(str, out) != std::errc()) {
+            ESP_LOGE(__FUNCTION__, "Falha ao converter \"%.*s\"", static_cast<int>(str.size()), str.data());
         }
-        ESP_LOGI(__FUNCTION__, "Tentando converter %s", str.c_str());
-        std::stringstream convert(str);
-        convert >> out;
-
         return out;
     }
 
@@ -71,7 +76,10 @@ public:
 
     static std::string trim(const std::string &str);
 
+    [[deprecated("Use StringToByteBuffer")]]
     static std::list<uint8_t> StringToByteList(const std::string &input);
+
+    static ByteBuffer StringToByteBuffer(std::string_view input);
 };
 
 
@@ -12,10 +12,11 @@ constexpr char TAG[] = "OtaManager";
 
 OtaManager::OtaManager() : initialized_(false) {
     // Conectar eventos do WifiOta aos eventos públicos usando addHandler
-    ota_.onUpdateStart.addHandler([this]() { onUpdateStart.trigger(); });
-    ota_.onUpdateComplete.addHandler([this]() { onUpdateComplete.trigger(); });
-    ota_.onUpdateFailed.addHandler([this]() { onUpdateFailed.trigger(); });
-    ota_.onProgress.addHandler([this](int progress) { onProgress.trigger(progress); });
+    // Os delegates guardam só o ponteiro this, sem alocação; os tokens removem os handlers na destruição
+    otaSubscriptions_[0] = ota_.onUpdateStart.addHandler([this]() { onUpdateStart.trigger(); });
+    otaSubscriptions_[1] = ota_.onUpdateComplete.addHandler([this]() { onUpdateComplete.trigger(); });
+    otaSubscriptions_[2] = ota_.onUpdateFailed.addHandler([this]() { onUpdateFailed.trigger(); });
+    otaSubscriptions_[3] = ota_.onProgress.addHandler([this](int progress) { onProgress.trigger(progress); });
 }
 
 OtaManager& OtaManager::instance() {
@@ -90,6 +90,7 @@ private:
     mutable char device_id_[17] = {0};  // 12 hex chars + null terminator
     mutable bool device_id_initialized_ = false;
     bool initialized_ = false;
+    EventSubscription otaSubscriptions_[4];  // Repasses dos eventos do WifiOta
     
     /**
      * @brief Inicializa device_id a partir do MAC address
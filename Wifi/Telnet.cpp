@@ -66,6 +66,21 @@ ErrorCode Telnet::send(const std::string& message) const {
     return sendRaw((const uint8_t*)message.c_str(), message.length());
 }
 
+ErrorCode Telnet::send(const uint8_t* data, size_t length) const {
+    if (!_client.connected()) {
+        return CommonErrorCodes::SocketClosed;
+    }
+    return sendRaw(data, length);
+}
+
+bool Telnet::isClientConnected() const {
+    return _client.connected();
+}
+
+void Telnet::disconnectClient() {
+    _client.disconnect();
+}
+
 ErrorCode Telnet::printf(const char* format, ...) const {
     if (!_client.connected()) {
         return CommonErrorCodes::SocketClosed;
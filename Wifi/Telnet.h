@@ -60,6 +60,27 @@ public:
      */
     [[nodiscard]] ErrorCode send(const std::string& message) const;
 
+    /**
+     * @brief Sends a byte array to the connected Telnet client.
+     *
+     * @param data Pointer to the byte array.
+     * @param length The length of the byte array.
+     * @return ErrorCode indicating success or failure.
+     */
+    [[nodiscard]] ErrorCode send(const uint8_t* data, size_t length) const;
+
+    /**
+     * @brief Checks if a Telnet client is connected.
+     *
+     * @return True if a client is connected, false otherwise.
+     */
+    [[nodiscard]] bool isClientConnected() const;
+
+    /**
+     * @brief Closes the connection with the current Telnet client, keeping the server running.
+     */
+    void disconnectClient();
+
     /**
      * @brief Sends a formatted string to the connected Telnet client (like printf).
      *
@@ -0,0 +1,42 @@
+#include "TelnetConnection.h"
+
+/**
+ * @file TelnetConnection.cpp
+ * @brief Implementation of the TelnetConnection class.
+ */
+
+TelnetConnection::TelnetConnection(Telnet& telnet) : BaseConnection(), _telnet(telnet) {
+    _connectedSubscription = _telnet.onClientConnected.addHandler([this]() {
+        _clientConnected = true;
+    });
+    // O Telnet avisa a cada volta enquanto não há cliente; só a primeira depois de uma conexão conta
+    _disconnectedSubscription = _telnet.onClientDisconnected.addHandler([this]() {
+        clientDisconnected();
+    });
+}
+
+void TelnetConnection::disconnect() {
+    _telnet.disconnectClient();
+    clientDisconnected();
+}
+
+void TelnetConnection::clientDisconnected() {
+    if (!_clientConnected) {
+        return;
+    }
+    _clientConnected = false;
+    onDisconnect.trigger(this, nullptr);
+}
+
+bool TelnetConnection::isConnected() const {
+    return _telnet.isClientConnected();
+}
+
+ErrorCode TelnetConnection::sendRawData(const uint8_t* data, size_t length) const {
+    ErrorCode err = _telnet.send(data, length);
+    if (err != CommonErrorCodes::None) {
+        return err;
+    }
+    static constexpr uint8_t LineBreak[] = {'\r', '\n'};
+    return _telnet.send(LineBreak, sizeof(LineBreak));
+}
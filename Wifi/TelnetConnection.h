@@ -0,0 +1,59 @@
+#ifndef TELNET_CONNECTION_H
+#define TELNET_CONNECTION_H
+
+#include "BaseConnection.h"
+#include "Telnet.h"
+
+/**
+ * @file TelnetConnection.h
+ * @brief This file defines the TelnetConnection class, the Telnet client seen as a BaseConnection.
+ */
+
+/**
+ * @class TelnetConnection
+ * @brief Presents the client of a Telnet server as a BaseConnection, so Commander can run commands for it and answer.
+ *
+ * Each payload sent is followed by a line break, so every JSON response shows up on its own line. onDisconnect is
+ * triggered when the client leaves as well as on disconnect(), so the state of the client (its user) is released
+ * either way.
+ */
+class TelnetConnection : public BaseConnection {
+public:
+    /**
+     * @brief Constructor.
+     *
+     * @param telnet The Telnet server whose client this connection represents. It must outlive the connection.
+     */
+    explicit TelnetConnection(Telnet& telnet);
+
+    /**
+     * @brief Closes the connection with the Telnet client.
+     */
+    void disconnect() override;
+
+    /**
+     * @brief Checks if a Telnet client is connected.
+     *
+     * @return True if connected, false otherwise.
+     */
+    [[nodiscard]] bool isConnected() const override;
+
+    /**
+     * @brief Sends raw byte data to the Telnet client, followed by a line break.
+     *
+     * @param data The data buffer to send.
+     * @param length The length of the data buffer.
+     * @return ErrorCode indicating success or failure.
+     */
+    ErrorCode sendRawData(const uint8_t* data, size_t length) const override;
+
+private:
+    Telnet& _telnet; /**< The Telnet server of the client. */
+    bool _clientConnected = false; /**< A client connected and onDisconnect was not triggered for it yet. */
+    EventSubscription _connectedSubscription;
+    EventSubscription _disconnectedSubscription;
+
+    void clientDisconnected();
+};
+
+#endif // TELNET_CONNECTION_H
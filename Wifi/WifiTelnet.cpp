@@ -1,9 +1,13 @@
 #include "WifiTelnet.h"
 #include "GeneralErrorCodes.h"
+#include "Tokenizer.h"
+#include "Trace.h"
+#include "Metrics.h"
+#include "Storage.h"
+#include "Commander.h"
 #include <esp_log.h>
 #include <esp_system.h>
 #include <algorithm>
-#include <sstream>
 #include <utility>
 #include <esp_chip_info.h>
 
@@ -42,16 +46,30 @@ ErrorCode WifiTelnet::start(const std::string& ssid, const std::string& password
         return err;
     }
 
+    err = registerCommand("trace", [this](auto && PH1) { return handleTraceCommand(std::forward<decltype(PH1)>(PH1)); });
+    if (err != CommonErrorCodes::None) {
+        ESP_LOGE("WifiTelnet", "Failed to register 'trace' command: %s", err.description().c_str());
+        return err;
+    }
+
+    err = registerCommand("stats", [this](auto && PH1) { return handleStatsCommand(std::forward<decltype(PH1)>(PH1)); });
+    if (err != CommonErrorCodes::None) {
+        ESP_LOGE("WifiTelnet", "Failed to register 'stats' command: %s", err.description().c_str());
+        return err;
+    }
+
     err = _telnet.start(ssid, password, ip, port); // Start Telnet server
     if (err != CommonErrorCodes::None) {
         ESP_LOGE("WifiTelnet", "Failed to start Telnet server: %s", err.description().c_str());
         return err;
     }
 
-    _telnet.onMessageReceived.addHandler([this](const std::string& message) {
-        auto commandLine = parseCommandLine(message);
-        if (!commandLine.empty()) {
-            ErrorCode execErr = executeCommand(commandLine[0], std::vector<std::string>(commandLine.begin() + 1, commandLine.end()));
+    _messageSubscription = _telnet.onMessageReceived.addHandler([this](const std::string& message) {
+        Tokenizer tokenizer(message, ' ', TokenizerMode::Words);
+        std::string_view command;
+        if (tokenizer.next(command)) {
+            auto arguments = std::string_view(message).substr(command.data() + command.size() - message.data());
+            ErrorCode execErr = executeCommand(command, arguments);
             if (execErr != CommonErrorCodes::None) {
                 execErr.log("WifiTelnet", ESP_LOG_WARN);
             }
@@ -65,6 +83,7 @@ ErrorCode WifiTelnet::start(const std::string& ssid, const std::string& password
 void WifiTelnet::stop() {
     if (_isRunning) {
         _telnet.stop();
+        _messageSubscription.reset();
         _isRunning = false;
         ESP_LOGI("WifiTelnet", "WifiTelnet server stopped.");
     }
@@ -72,6 +91,12 @@ void WifiTelnet::stop() {
 
 ErrorCode WifiTelnet::registerCommand(const std::string& command,
                                       std::function<ErrorCode(const std::vector<std::string>&)> handler) {
+    if (command.empty() || command.size() > MaxCommandLength) {
+        ESP_LOGE("WifiTelnet", "Command '%s' must have 1 to %u characters.", command.c_str(),
+                 static_cast<unsigned>(MaxCommandLength));
+        return CommonErrorCodes::ArgumentError;
+    }
+
     std::string lowerCaseCommand = command;
     std::transform(lowerCaseCommand.begin(), lowerCaseCommand.end(), lowerCaseCommand.begin(),
                    [](unsigned char c){ return std::tolower(c); });
@@ -91,30 +116,42 @@ void WifiTelnet::handle() {
     }
 }
 
-std::vector<std::string> WifiTelnet::parseCommandLine(const std::string& commandLine) {
-    std::vector<std::string> result;
-    std::istringstream iss(commandLine);
-    std::string token;
+std::vector<std::string> WifiTelnet::parseArguments(Tokenizer& tokenizer) {
+    std::vector<std::string> args;
+    args.reserve(tokenizer.count());
 
-    while (std::getline(iss, token, ' ')) {
-        result.push_back(token);
+    std::string_view token;
+    while (tokenizer.next(token)) {
+        args.push_back(Tokenizer::decode(token));
     }
 
-    return result;
+    return args;
 }
 
-ErrorCode WifiTelnet::executeCommand(const std::string& command, const std::vector<std::string>& args) const {
-    std::string lowerCaseCommand = command;
-    std::transform(lowerCaseCommand.begin(), lowerCaseCommand.end(), lowerCaseCommand.begin(),
-                   [](unsigned char c){ return std::tolower(c); });
+ErrorCode WifiTelnet::executeCommand(std::string_view command, std::string_view arguments) {
+    char lowerCaseCommand[MaxCommandLength];
+    auto it = _commandHandlers.end();
+    if (command.size() <= sizeof(lowerCaseCommand)) {
+        std::transform(command.begin(), command.end(), lowerCaseCommand,
+                       [](unsigned char c){ return std::tolower(c); });
+        it = _commandHandlers.find(std::string_view(lowerCaseCommand, command.size()));
+    }
 
-    auto it = _commandHandlers.find(lowerCaseCommand);
     if (it != _commandHandlers.end()) {
-        return it->second(args);
-    } else {
-        printMessage("Unknown command: " + command + "\n");
+        Tokenizer tokenizer(arguments, ' ', TokenizerMode::Words);
+        return it->second(parseArguments(tokenizer));
+    }
+
+    // Comandos do dispositivo: mesma fila e mesmas tarefas do Bluetooth, a resposta chega como JSON
+    ErrorCode err = Commander::CheckForNamedCommand(command, arguments, &_connection);
+    if (err == CommonErrorCodes::InvalidCommand) {
+        printMessage("Unknown command: " + std::string(command) + "\n");
         return CommonErrorCodes::OperationFailed;
     }
+    if (err == CommonErrorCodes::ArgumentError) {
+        printMessage("Invalid arguments for " + std::string(command) + "\n");
+    }
+    return err == CommonErrorCodes::Busy ? CommonErrorCodes::None : err;
 }
 
 ErrorCode WifiTelnet::handleHelpCommand([[maybe_unused]] const std::vector<std::string>& args) const {
@@ -122,6 +159,10 @@ ErrorCode WifiTelnet::handleHelpCommand([[maybe_unused]] const std::vector<std::
     for (const auto &handler: _commandHandlers) {
         printMessage("  " + handler.first + "\n");
     }
+    printMessage("Device commands:\n");
+    for (const auto &command: Commander::GetCommands()) {
+        printMessage("  " + command.InternalName + " (" + std::to_string(command.DataSize) + " args)\n");
+    }
 
     return CommonErrorCodes::None;
 }
@@ -156,6 +197,46 @@ ErrorCode WifiTelnet::handleInfoCommand([[maybe_unused]] const std::vector<std::
     return CommonErrorCodes::None;
 }
 
+ErrorCode WifiTelnet::handleTraceCommand(const std::vector<std::string>& args) const {
+    if (!args.empty() && args[0] == "clear") {
+        Trace::clear();
+        printMessage("Trace cleared.\n");
+        return CommonErrorCodes::None;
+    }
+
+    if (!args.empty() && args[0] == "store") {
+        ErrorCode err = args.size() > 1 ? Storage::storeTrace(args[1]) : Storage::storeTrace();
+        printMessage(err == CommonErrorCodes::None ? "Trace stored.\n" : "Failed to store trace: " + err.description() + "\n");
+        return err;
+    }
+
+    // Junta os pedaços do JSON para não mandar um pacote por evento
+    std::string buffer;
+    buffer.reserve(TraceChunkSize + 192);
+    Trace::writeChromeJson([this, &buffer](std::string_view chunk) {
+        buffer.append(chunk);
+        if (buffer.size() >= TraceChunkSize) {
+            printMessage(buffer);
+            buffer.clear();
+        }
+    });
+    buffer.push_back('\n');
+    printMessage(buffer);
+    return CommonErrorCodes::None;
+}
+
+ErrorCode WifiTelnet::handleStatsCommand(const std::vector<std::string>& args) const {
+    if (!args.empty() && args[0] == "reset") {
+        Metrics::reset();
+        printMessage("Metrics reset.\n");
+        return CommonErrorCodes::None;
+    }
+
+    Metrics::sample();
+    printMessage(Metrics::toJson().dump(2) + "\n");
+    return CommonErrorCodes::None;
+}
+
 void WifiTelnet::printMessage(const std::string& message) const {
    auto error = _telnet.send(message);
    error.log("WifiTelnet");
@@ -4,7 +4,11 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <map>
+#include <string_view>
 #include "Telnet.h"
+#include "TelnetConnection.h"
+#include "Tokenizer.h"
 #include "WifiOta.h"
 #include "ErrorCode.h"
 
@@ -17,7 +21,9 @@
  * @class WifiTelnet
  * @brief A Telnet server that allows you to manage and control your ESP32 device remotely.
  *
- * Provides commands for OTA updates, system information, and custom command handling.
+ * Provides commands for OTA updates, system information, and custom command handling. Lines that match no
+ * Telnet command are looked up by name in Commander, so the device commands run on the same workers as the
+ * ones received over Bluetooth and answer on the Telnet client.
  */
 class WifiTelnet {
 public:
@@ -67,27 +73,35 @@ public:
 
 private:
     Telnet _telnet; /**< The underlying Telnet server object. */
+    TelnetConnection _connection{_telnet}; /**< The Telnet client as a connection, for Commander. */
     mutable WifiOta _ota; /**< The WifiOta object for handling OTA updates. */
     bool _isRunning;  /**< Flag to indicate whether the Telnet server is running. */
+    EventSubscription _messageSubscription; /**< Subscription to the Telnet message event. */
 
-    std::map<std::string, std::function<ErrorCode(const std::vector<std::string>&)>> _commandHandlers; /**< Map of registered command handlers. */
+    static constexpr size_t MaxCommandLength = 32; /**< Longer command names never match a handler. */
+
+    static constexpr size_t TraceChunkSize = 512; /**< Bytes of trace JSON sent per Telnet message. */
+
+    std::map<std::string, std::function<ErrorCode(const std::vector<std::string>&)>, std::less<>> _commandHandlers; /**< Map of registered command handlers, searchable by std::string_view. */
 
     /**
-     * @brief Parses a command string and its arguments.
+     * @brief Collects the remaining tokens of a command line as arguments.
      *
-     * @param commandLine The full command line received from the Telnet client.
-     * @return A vector containing the command and its arguments.
+     * Words are separated by spaces; quotes group words and a backslash escapes the next character.
+     *
+     * @param tokenizer Tokenizer positioned after the command name.
+     * @return The decoded arguments.
      */
-    [[nodiscard]] static std::vector<std::string> parseCommandLine(const std::string& commandLine) ;
+    [[nodiscard]] static std::vector<std::string> parseArguments(Tokenizer& tokenizer);
 
     /**
-     * @brief Executes a Telnet command.
+     * @brief Executes a Telnet command, or queues the Commander command with that name.
      *
      * @param command The command to execute.
-     * @param args The arguments for the command.
+     * @param arguments The rest of the line, with the arguments for the command.
      * @return ErrorCode indicating the result of the command execution.
      */
-    [[nodiscard]] ErrorCode executeCommand(const std::string& command, const std::vector<std::string>& args) const;
+    [[nodiscard]] ErrorCode executeCommand(std::string_view command, std::string_view arguments);
 
     /**
      * @brief Handles the "help" command, listing available commands.
@@ -113,6 +127,22 @@ private:
      */
     [[nodiscard]] ErrorCode handleInfoCommand([[maybe_unused]] const std::vector<std::string>& args) const;
 
+    /**
+     * @brief Handles the "trace" command, printing the trace ring as Chrome Trace Event JSON.
+     *
+     * @param args "clear" empties the ring, "store [file]" writes it to Storage instead of printing.
+     * @return ErrorCode indicating success or failure.
+     */
+    [[nodiscard]] ErrorCode handleTraceCommand(const std::vector<std::string>& args) const;
+
+    /**
+     * @brief Handles the "stats" command, printing the Metrics registry as JSON.
+     *
+     * @param args "reset" zeroes the counters and histograms instead.
+     * @return ErrorCode indicating success or failure.
+     */
+    [[nodiscard]] ErrorCode handleStatsCommand(const std::vector<std::string>& args) const;
+
     /**
      * @brief Prints a message to the Telnet client.
      *
@@ -0,0 +1,11 @@
+#ifndef PRIORITIES_H
+#define PRIORITIES_H
+
+// Prioridades das tarefas dos componentes, que cada projeto define
+#define HIGH_PRIORITY 5
+
+#ifndef MEDIUM_PRIORITY
+#define MEDIUM_PRIORITY 4
+#endif
+
+#endif //PRIORITIES_H
@@ -0,0 +1,50 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <cstdint>
+#include <esp_timer.h>
+
+/**
+ * Medição dos benchmarks. Cada caso compara a implementação antiga com a nova no mesmo trabalho e o resultado
+ * vai para o log em ns por operação.
+ */
+class Bench {
+public:
+    Bench() = delete;
+
+    /**
+     * Roda body(i) para cada i em [0, iterations). Retorna o tempo total, em µs.
+     */
+    template<typename Body>
+    static int64_t measure(uint32_t iterations, Body &&body) {
+        int64_t start = esp_timer_get_time();
+        for (uint32_t i = 0; i < iterations; i++) {
+            body(i);
+        }
+        return esp_timer_get_time() - start;
+    }
+
+    /**
+     * Loga o caso: o tempo por operação do antigo e do novo e quantas vezes o novo é mais rápido.
+     */
+    static void report(const char *name, uint32_t operations, int64_t baselineUs, int64_t candidateUs);
+
+    /**
+     * Destino dos resultados calculados, para o compilador não eliminar o trabalho medido.
+     */
+    static volatile uint32_t sink;
+};
+
+void RunQueueBench();
+
+void RunMapBench();
+
+void RunTokenizerBench();
+
+void RunBatchBench();
+
+void RunNotifyBench();
+
+void RunConvertBench();
+
+#endif //BENCH_H
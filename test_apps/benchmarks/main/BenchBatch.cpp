@@ -0,0 +1,109 @@
+#include <atomic>
+#include <string>
+#include <esp_log.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <BaseConnection.h>
+#include <Commander.h>
+#include <JsonModels.h>
+#include "Bench.h"
+
+// Comandos avulsos contra lotes (COMMAND_BATCH_CODE) num transporte em loopback: o cliente manda um pacote e
+// espera a resposta antes do próximo, como um cliente BLE ou telnet
+
+static constexpr uint8_t PingCode = 0x60;
+static constexpr uint32_t BatchSize = 10;
+static constexpr uint32_t Rounds = 200;
+static constexpr TickType_t AnswerTimeout = pdMS_TO_TICKS(1000);
+
+static_assert(BatchSize <= COMMAND_MAX_ARGS, "A batch holds at most COMMAND_MAX_ARGS commands");
+
+/**
+ * Conexão sem rádio: cada escrita é uma resposta entregue ao cliente.
+ */
+class LoopbackConnection : public BaseConnection {
+public:
+    void disconnect() override {}
+
+    [[nodiscard]] bool isConnected() const override {
+        return true;
+    }
+
+    ErrorCode sendRawData(const uint8_t *, size_t length) const override {
+        bytes.fetch_add(length, std::memory_order_relaxed);
+        xSemaphoreGive(answered);
+        return CommonErrorCodes::None;
+    }
+
+    bool waitAnswer() const {
+        return xSemaphoreTake(answered, AnswerTimeout) == pdTRUE;
+    }
+
+    mutable std::atomic<uint32_t> bytes{0};
+
+private:
+    SemaphoreHandle_t answered = xSemaphoreCreateBinary();
+};
+
+static LoopbackConnection loopback;//NOLINT
+
+/**
+ * Um comando curto típico: responde com o próprio resultado.
+ */
+static void Ping(const CommandArgs &, BaseConnection *connection) {
+    JsonModels::CommandResultJson result;
+    result.Command = PingCode;
+    connection->sendJson(result.toJson());
+}
+
+static std::string Command(uint32_t argument) {
+    return std::string(1, static_cast<char>(PingCode)) + std::to_string(argument);
+}
+
+/**
+ * Manda o pacote e espera a resposta. Retorna false (e loga) se ela não vier.
+ */
+static bool RoundTrip(const std::string &packet) {
+    if (Commander::CheckForCommand(packet, &loopback) != CommonErrorCodes::None || !loopback.waitAnswer()) {
+        ESP_LOGE("Bench", "Comando sem resposta no loopback");
+        return false;
+    }
+    return true;
+}
+
+void RunBatchBench() {
+    Commander::AddCommand(DeviceCommand(1, "BenchPing", PingCode,
+                                        std::function<void(const CommandArgs &, BaseConnection *)>(Ping)));
+    Commander::Init();
+    // O limite de taxa recusaria os avulsos; aqui só interessa o custo de cada caminho
+    Commander::SetRate(0, COMMAND_RATE_BURST);
+
+    // Um lote em texto: a linha do modo (vazia: executa tudo) e um comando por linha
+    std::string batch(1, static_cast<char>(COMMAND_BATCH_CODE));
+    batch += '\n';
+    std::string singles[BatchSize];
+    for (uint32_t i = 0; i < BatchSize; i++) {
+        singles[i] = Command(i);
+        batch += singles[i];
+        batch += '\n';
+    }
+
+    bool ok = true;
+    uint32_t singleBytes = loopback.bytes.load();
+    int64_t baseline = Bench::measure(Rounds * BatchSize, [&](uint32_t i) {
+        ok = ok && RoundTrip(singles[i % BatchSize]);
+    });
+    singleBytes = loopback.bytes.load() - singleBytes;
+
+    uint32_t batchBytes = loopback.bytes.load();
+    int64_t candidate = Bench::measure(Rounds, [&](uint32_t) {
+        ok = ok && RoundTrip(batch);
+    });
+    batchBytes = loopback.bytes.load() - batchBytes;
+    if (!ok) return;
+
+    // Os dois casos executam Rounds * BatchSize comandos: o tempo sai por comando
+    Bench::report("comandos: avulsos x lotes de 10", Rounds * BatchSize, baseline, candidate);
+    ESP_LOGI("Bench", "%-36s antigo %9u bytes        novo %9u bytes", "comandos: bytes respondidos",
+             static_cast<unsigned>(singleBytes), static_cast<unsigned>(batchBytes));
+}
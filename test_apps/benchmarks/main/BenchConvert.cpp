@@ -0,0 +1,72 @@
+#include <sstream>
+#include <string>
+#include <Convert.h>
+#include "Bench.h"
+
+// Convert (std::from_chars/std::to_chars) contra o std::stringstream que Utility e Storage usavam antes
+
+static constexpr uint32_t Operations = 20000;
+
+// Valores como os que passam pelo Storage e pelos argumentos dos comandos
+static const std::string integers[] = {"0", "42", "1500", "-273", "65535", "123456"};//NOLINT
+static const std::string decimals[] = {"0.5", "23.75", "-12.125", "3.14159", "1013.25", "0.001"};//NOLINT
+static constexpr size_t ValueCount = sizeof(integers) / sizeof(integers[0]);
+
+/**
+ * GetConvertedFromString como era antes, sem o log INFO que ele fazia a cada chamada.
+ */
+template<typename T>
+static T LegacyFromString(const std::string &str) {
+    T out{};
+    std::stringstream convert(str);
+    convert >> out;
+    return out;
+}
+
+/**
+ * A escrita antiga do Storage: o valor passava por um stringstream.
+ */
+template<typename T>
+static std::string LegacyToString(const T &value) {
+    std::stringstream convert;
+    convert << value;
+    return convert.str();
+}
+
+template<typename T>
+static void CompareFromString(const char *name, const std::string (&texts)[ValueCount]) {
+    int64_t baseline = Bench::measure(Operations, [&texts](uint32_t i) {
+        Bench::sink = static_cast<uint32_t>(static_cast<int32_t>(LegacyFromString<T>(texts[i % ValueCount])));
+    });
+
+    int64_t candidate = Bench::measure(Operations, [&texts](uint32_t i) {
+        T value{};
+        Convert::fromString(texts[i % ValueCount], value);
+        Bench::sink = static_cast<uint32_t>(static_cast<int32_t>(value));
+    });
+
+    Bench::report(name, Operations, baseline, candidate);
+}
+
+template<typename T>
+static void CompareToString(const char *name, const std::string (&texts)[ValueCount]) {
+    T values[ValueCount];
+    for (size_t i = 0; i < ValueCount; i++) values[i] = Convert::fromStringOr<T>(texts[i], T{});
+
+    int64_t baseline = Bench::measure(Operations, [&values](uint32_t i) {
+        Bench::sink = LegacyToString(values[i % ValueCount]).size();
+    });
+
+    int64_t candidate = Bench::measure(Operations, [&values](uint32_t i) {
+        Bench::sink = Convert::toString(values[i % ValueCount]).size();
+    });
+
+    Bench::report(name, Operations, baseline, candidate);
+}
+
+void RunConvertBench() {
+    CompareFromString<int32_t>("convert: texto -> int32", integers);
+    CompareFromString<float>("convert: texto -> float", decimals);
+    CompareToString<int32_t>("convert: int32 -> texto", integers);
+    CompareToString<float>("convert: float -> texto", decimals);
+}
@@ -0,0 +1,26 @@
+#include <esp_log.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "Bench.h"
+
+volatile uint32_t Bench::sink = 0;
+
+void Bench::report(const char *name, uint32_t operations, int64_t baselineUs, int64_t candidateUs) {
+    double baseline = static_cast<double>(baselineUs) * 1000.0 / operations;
+    double candidate = static_cast<double>(candidateUs) * 1000.0 / operations;
+    ESP_LOGI("Bench", "%-36s antigo %9.1f ns/op  novo %9.1f ns/op  %5.2fx", name, baseline, candidate,
+             candidate > 0 ? baseline / candidate : 0.0);
+}
+
+extern "C" void app_main() {
+    // Dá tempo para o boot terminar de logar antes das medidas
+    vTaskDelay(pdMS_TO_TICKS(500));
+    ESP_LOGI("Bench", "Início dos benchmarks");
+    RunQueueBench();
+    RunMapBench();
+    RunTokenizerBench();
+    RunBatchBench();
+    RunNotifyBench();
+    RunConvertBench();
+    ESP_LOGI("Bench", "Fim dos benchmarks");
+}
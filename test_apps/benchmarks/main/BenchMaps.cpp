@@ -0,0 +1,110 @@
+#include <array>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <SafeMap.h>
+#include <StripedHashMap.h>
+#include <Utility.h>
+#include <priorities.h>
+#include "Bench.h"
+
+// StripedHashMap contra SafeMap com chaves std::string, como os nomes de parâmetros e sensores
+
+static constexpr size_t KeyCount = 48;
+static constexpr uint32_t SingleTaskOperations = 50000;
+static constexpr uint32_t MixedOperations = 50000; /**< Por tarefa */
+static constexpr uint32_t WriteEvery = 5;          /**< Uma escrita a cada cinco operações: 80% leituras */
+
+static std::array<std::string, KeyCount> keys;//NOLINT
+
+struct OldMap {
+    SafeMap<std::string, uint32_t> map;
+
+    void read(size_t key) {
+        auto [found, value] = map[keys[key]];
+        Bench::sink = found ? value : 0;
+    }
+
+    void write(size_t key, uint32_t value) {
+        map.AddOrUpdate(keys[key], value);
+    }
+};
+
+struct NewMap {
+    StripedHashMap<std::string, uint32_t, 128, 8> map;
+
+    void read(size_t key) {
+        uint32_t value = 0;
+        map.TryGet(std::string_view(keys[key]), value);
+        Bench::sink = value;
+    }
+
+    void write(size_t key, uint32_t value) {
+        map.Update(std::string_view(keys[key]), [value](uint32_t &stored) { stored = value; });
+    }
+};
+
+static OldMap oldMap;//NOLINT
+static NewMap newMap;//NOLINT
+static SemaphoreHandle_t helperDone = xSemaphoreCreateBinary();//NOLINT
+
+template<typename Map>
+static void Fill(Map &map) {
+    for (size_t key = 0; key < KeyCount; key++) {
+        map.map.AddOrUpdate(keys[key], static_cast<uint32_t>(key));
+    }
+}
+
+template<typename Map>
+static void Mixed(Map &map, uint32_t seed) {
+    for (uint32_t i = 0; i < MixedOperations; i++) {
+        size_t key = (i * 7 + seed) % KeyCount;
+        if (i % WriteEvery == 0) {
+            map.write(key, i);
+        } else {
+            map.read(key);
+        }
+    }
+}
+
+template<typename Map>
+static void MixedHelper(void *arg) {
+    Mixed(*static_cast<Map *>(arg), 13);
+    xSemaphoreGive(helperDone);
+    vTaskDelete(nullptr);
+}
+
+/**
+ * As duas tarefas, uma em cada núcleo (se houver), lendo e escrevendo as mesmas chaves ao mesmo tempo.
+ */
+template<typename Map>
+static int64_t BothCores(Map &map) {
+    int64_t start = esp_timer_get_time();
+    Utility::CreateAndProfile("BenchMapHelper", MixedHelper<Map>, 4096, 1, portNUM_PROCESSORS - 1, &map);
+    Mixed(map, 0);
+    xSemaphoreTake(helperDone, portMAX_DELAY);
+    return esp_timer_get_time() - start;
+}
+
+void RunMapBench() {
+    char name[16];
+    for (size_t key = 0; key < KeyCount; key++) {
+        snprintf(name, sizeof(name), "sensor.%u", static_cast<unsigned>(key));
+        keys[key] = name;
+    }
+    Fill(oldMap);
+    Fill(newMap);
+
+    auto lookup = [](auto &map) {
+        return Bench::measure(SingleTaskOperations, [&map](uint32_t i) { map.read(i % KeyCount); });
+    };
+    int64_t baseline = lookup(oldMap);
+    int64_t candidate = lookup(newMap);
+    Bench::report("mapa: leitura, uma tarefa", SingleTaskOperations, baseline, candidate);
+
+    baseline = BothCores(oldMap);
+    candidate = BothCores(newMap);
+    Bench::report("mapa: 80% leitura, dois núcleos", 2 * MixedOperations, baseline, candidate);
+}
@@ -0,0 +1,132 @@
+#include <string>
+#include <esp_log.h>
+#include <nlohmann/json.hpp>
+#include <BaseConnection.h>
+#include <NotificationHub.h>
+#include "Bench.h"
+
+// NotificationHub (serializa cada tópico uma vez por rodada) contra serializar e enviar para cada conexão
+
+static constexpr size_t ConnectionCount = 4;
+static constexpr uint32_t Rounds = 500;
+static constexpr uint32_t ChangesPerRound = 4;
+
+/**
+ * Conexão sem rádio que só conta o que recebe.
+ */
+class CountingConnection : public BaseConnection {
+public:
+    void disconnect() override {}
+
+    [[nodiscard]] bool isConnected() const override {
+        return true;
+    }
+
+    ErrorCode sendRawData(const uint8_t *, size_t length) const override {
+        bytes += length;
+        return CommonErrorCodes::None;
+    }
+
+    mutable uint32_t bytes = 0;
+};
+
+static CountingConnection connections[ConnectionCount];//NOLINT
+static uint32_t sequence = 0;//NOLINT
+
+static void SerializeStatus(std::string &json) {
+    nlohmann::json status;
+    status["Sequence"] = sequence;
+    status["Temperature"] = 23.5 + (sequence % 10) * 0.1;
+    status["Running"] = true;
+    status["Uptime"] = esp_timer_get_time() / 1000000;
+    json = status.dump();
+}
+
+static void SerializeConfig(std::string &json) {
+    nlohmann::json config;
+    config["Ssid"] = "MinhaRede";
+    config["Channel"] = 6;
+    config["Interval"] = 500;
+    config["Sequence"] = sequence;
+    json = config.dump();
+}
+
+static void (*const serializers[])(std::string &) = {SerializeStatus, SerializeConfig};
+
+static uint32_t SentBytes() {
+    uint32_t bytes = 0;
+    for (const auto &connection: connections) bytes += connection.bytes;
+    return bytes;
+}
+
+/**
+ * O jeito antigo: cada conexão serializa o estado de novo e envia.
+ */
+static void SendPerConnection() {
+    for (const auto &connection: connections) {
+        for (auto serialize: serializers) {
+            std::string json;
+            serialize(json);
+            connection.sendJson(json);
+        }
+    }
+}
+
+static void Round() {
+    uint32_t changed = NotificationHub::prepare();
+    for (auto &connection: connections) {
+        NotificationHub::deliver(&connection, changed);
+    }
+}
+
+void RunNotifyBench() {
+    uint8_t topics[] = {NotificationHub::addTopic("status", SerializeStatus),
+                        NotificationHub::addTopic("config", SerializeConfig)};
+    for (auto &connection: connections) {
+        for (auto topic: topics) NotificationHub::subscribe(&connection, topic);
+    }
+    // A primeira rodada envia o estado inicial a quem acabou de assinar
+    Round();
+
+    auto markAll = [&topics]() {
+        sequence++;
+        for (auto topic: topics) NotificationHub::markDirty(topic);
+    };
+
+    // Uma mudança por rodada: a diferença é só a serialização repetida por conexão
+    uint32_t bytes = SentBytes();
+    int64_t baseline = Bench::measure(Rounds, [](uint32_t) {
+        sequence++;
+        SendPerConnection();
+    });
+    uint32_t baselineBytes = SentBytes() - bytes;
+
+    bytes = SentBytes();
+    int64_t candidate = Bench::measure(Rounds, [&markAll](uint32_t) {
+        markAll();
+        Round();
+    });
+    uint32_t candidateBytes = SentBytes() - bytes;
+    Bench::report("notificações: rodada, 4 conexões", Rounds, baseline, candidate);
+    ESP_LOGI("Bench", "%-36s antigo %9u bytes        novo %9u bytes", "notificações: bytes por rodada",
+             static_cast<unsigned>(baselineBytes / Rounds), static_cast<unsigned>(candidateBytes / Rounds));
+
+    // Mudanças mais rápidas que as rodadas: o antigo envia cada uma, o hub junta numa só
+    bytes = SentBytes();
+    baseline = Bench::measure(Rounds * ChangesPerRound, [](uint32_t) {
+        sequence++;
+        SendPerConnection();
+    });
+    baselineBytes = SentBytes() - bytes;
+
+    bytes = SentBytes();
+    candidate = Bench::measure(Rounds * ChangesPerRound, [&markAll](uint32_t i) {
+        markAll();
+        if (i % ChangesPerRound == ChangesPerRound - 1) Round();
+    });
+    candidateBytes = SentBytes() - bytes;
+    Bench::report("notificações: 4 mudanças por rodada", Rounds * ChangesPerRound, baseline, candidate);
+    ESP_LOGI("Bench", "%-36s antigo %9u bytes        novo %9u bytes", "notificações: bytes por mudança",
+             static_cast<unsigned>(baselineBytes / (Rounds * ChangesPerRound)),
+             static_cast<unsigned>(candidateBytes / (Rounds * ChangesPerRound)));
+}
@@ -0,0 +1,109 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <BoundedQueue.h>
+#include <SafeList.h>
+#include <Utility.h>
+#include <priorities.h>
+#include "Bench.h"
+
+// MpmcQueue contra a fila do FreeRTOS (mesma capacidade) e a SafeList, com itens de 4 bytes
+
+static constexpr size_t QueueLength = 64;
+static constexpr uint32_t SingleTaskOperations = 100000;
+static constexpr uint32_t CrossTaskOperations = 50000;
+
+struct FreeRtosQueue {
+    QueueHandle_t queue = xQueueCreate(QueueLength, sizeof(uint32_t));
+
+    bool tryPush(uint32_t item) {
+        return xQueueSendToBack(queue, &item, 0) == pdPASS;
+    }
+
+    bool tryPop(uint32_t &item) {
+        return xQueueReceive(queue, &item, 0) == pdPASS;
+    }
+
+    bool push(uint32_t item) {
+        return xQueueSendToBack(queue, &item, portMAX_DELAY) == pdPASS;
+    }
+
+    bool pop(uint32_t &item) {
+        return xQueueReceive(queue, &item, portMAX_DELAY) == pdPASS;
+    }
+};
+
+/**
+ * SafeList usada como fila, como antes da MpmcQueue: um nó no heap e um mutex por operação.
+ */
+struct ListQueue {
+    SafeList<uint32_t> list;
+
+    bool tryPush(uint32_t item) {
+        list.Push(item);
+        return true;
+    }
+
+    bool tryPop(uint32_t &item) {
+        item = list.PopFront();
+        return true;
+    }
+};
+
+static MpmcQueue<uint32_t, QueueLength> mpmcQueue;//NOLINT
+static ListQueue listQueue;//NOLINT
+static FreeRtosQueue freeRtosQueue;//NOLINT
+static SemaphoreHandle_t producerDone = xSemaphoreCreateBinary();//NOLINT
+
+/**
+ * Sem disputa: uma tarefa põe e tira, o custo fixo de cada operação.
+ */
+template<typename Queue>
+static int64_t SingleTask(Queue &queue) {
+    return Bench::measure(SingleTaskOperations, [&queue](uint32_t i) {
+        uint32_t item;
+        queue.tryPush(i);
+        queue.tryPop(item);
+        Bench::sink = item;
+    });
+}
+
+template<typename Queue>
+static void Produce(void *arg) {
+    auto &queue = *static_cast<Queue *>(arg);
+    for (uint32_t i = 0; i < CrossTaskOperations; i++) {
+        queue.push(i);
+    }
+    xSemaphoreGive(producerDone);
+    vTaskDelete(nullptr);
+}
+
+/**
+ * Uma tarefa produz no outro núcleo (se houver) e esta consome, esperando quando a fila esvazia.
+ */
+template<typename Queue>
+static int64_t CrossTask(Queue &queue) {
+    int64_t start = esp_timer_get_time();
+    Utility::CreateAndProfile("BenchProducer", Produce<Queue>, 4096, HIGH_PRIORITY, portNUM_PROCESSORS - 1,
+                              &queue);
+    uint32_t item = 0;
+    for (uint32_t i = 0; i < CrossTaskOperations; i++) {
+        queue.pop(item);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    xSemaphoreTake(producerDone, portMAX_DELAY);
+    Bench::sink = item;
+    return elapsed;
+}
+
+void RunQueueBench() {
+    int64_t baseline = SingleTask(freeRtosQueue);
+    int64_t candidate = SingleTask(mpmcQueue);
+    Bench::report("fila: FreeRTOS push+pop, uma tarefa", SingleTaskOperations, baseline, candidate);
+    baseline = SingleTask(listQueue);
+    Bench::report("fila: SafeList push+pop, uma tarefa", SingleTaskOperations, baseline, candidate);
+
+    baseline = CrossTask(freeRtosQueue);
+    candidate = CrossTask(mpmcQueue);
+    Bench::report("fila: produtor e consumidor", CrossTaskOperations, baseline, candidate);
+}
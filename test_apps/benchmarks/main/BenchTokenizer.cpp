@@ -0,0 +1,63 @@
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <Tokenizer.h>
+#include <Utility.h>
+#include "Bench.h"
+
+// Tokenizer contra o antigo Utility::split, nas linhas de comando que chegam ao Commander
+
+static constexpr uint32_t Operations = 20000;
+
+/**
+ * Utility::split como era antes do Tokenizer: um istringstream e uma string por campo, mais a cópia do trim.
+ */
+static std::vector<std::string> LegacySplit(const std::string &source, char delimiter) {
+    std::vector<std::string> strings;
+    std::istringstream iss(source);
+    std::string s;
+
+    if (iss.peek() == '{') {
+        std::string json;
+        std::getline(iss, json);
+        strings.push_back(json);
+        return strings;
+    }
+
+    while (std::getline(iss, s, delimiter)) {
+        strings.push_back(Utility::trim(s));
+    }
+
+    return strings;
+}
+
+// Código do comando no primeiro byte e os argumentos separados por ':'
+static const std::string lines[] = {//NOLINT
+        "\x10MinhaRede:senha secreta:1",
+        "\x21" "42:1500:0:255",
+        "\x30usuario:Nome Completo:admin:1",
+        "\x12{\"Ssid\":\"MinhaRede\",\"Channel\":6}",
+};
+static constexpr size_t LineCount = sizeof(lines) / sizeof(lines[0]);
+
+void RunTokenizerBench() {
+    int64_t baseline = Bench::measure(Operations, [](uint32_t i) {
+        // O CheckForCommand antigo ainda copiava o pacote sem o código antes de separar
+        const auto &line = lines[i % LineCount];
+        auto data = LegacySplit(std::string(line.c_str() + 1), ':');
+        size_t size = 0;
+        for (const auto &token: data) size += token.size();
+        Bench::sink = size;
+    });
+
+    int64_t candidate = Bench::measure(Operations, [](uint32_t i) {
+        Tokenizer tokenizer(std::string_view(lines[i % LineCount]).substr(1), ':');
+        std::string_view token;
+        size_t size = 0;
+        while (tokenizer.next(token)) size += token.size();
+        Bench::sink = size;
+    });
+
+    Bench::report("tokenizer: linha de comando", Operations, baseline, candidate);
+}
@@ -0,0 +1,11 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+
+extern "C" void app_main() {
+    // Dá tempo para o boot terminar de logar antes dos testes
+    vTaskDelay(pdMS_TO_TICKS(500));
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    UNITY_END();
+}
@@ -0,0 +1,60 @@
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+#include <TimerService.h>
+
+static TimerHandle first;//NOLINT
+static TimerHandle second;//NOLINT
+static std::atomic<uint32_t> runs{0};
+
+/**
+ * Agenda os dois timers no mesmo tick, para saírem na mesma rodada do serviço.
+ */
+template<typename First, typename Second>
+static void ScheduleSiblings(uint32_t delayMs, First &&onFirst, Second &&onSecond) {
+    vTaskDelay(1);
+    first = TimerService::scheduleOnce(delayMs, std::forward<First>(onFirst));
+    second = TimerService::scheduleOnce(delayMs, std::forward<Second>(onSecond));
+    TEST_ASSERT_TRUE(first.isValid());
+    TEST_ASSERT_TRUE(second.isValid());
+}
+
+TEST_CASE("cancelar um timer da mesma rodada impede que ele execute", "[TimerService]") {
+    TEST_ASSERT_TRUE(TimerService::start());
+    runs = 0;
+
+    // Quem executar primeiro cancela o outro, que já foi tirado da roda junto com ele
+    ScheduleSiblings(20, []() {
+        runs++;
+        TimerService::cancel(second);
+    }, []() {
+        runs++;
+        TimerService::cancel(first);
+    });
+
+    vTaskDelay(pdMS_TO_TICKS(100));
+    TEST_ASSERT_EQUAL_UINT32(1, runs.load());
+    TEST_ASSERT_FALSE(TimerService::isActive(first));
+    TEST_ASSERT_FALSE(TimerService::isActive(second));
+}
+
+TEST_CASE("timer cancelado não conta como disparo", "[TimerService]") {
+    TEST_ASSERT_TRUE(TimerService::start());
+    runs = 0;
+    uint32_t fired = TimerService::getStats().fired;
+
+    ScheduleSiblings(20, []() {
+        runs++;
+        TimerService::cancel(second);
+    }, []() {
+        runs++;
+        TimerService::cancel(first);
+    });
+
+    vTaskDelay(pdMS_TO_TICKS(100));
+    TEST_ASSERT_EQUAL_UINT32(1, runs.load());
+    TEST_ASSERT_EQUAL_UINT32(fired + 1, TimerService::getStats().fired);
+    // Os dois nós voltaram para a lista livre
+    TEST_ASSERT_EQUAL_UINT32(0, TimerService::getStats().active);
+}